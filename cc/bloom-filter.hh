@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+      // Set of strings answering "definitely not there" or "maybe there", about 1%
+      // of values not added are reported as maybe there. Default constructed
+      // (not made) filter reports everything as maybe there.
+    class BloomFilter
+    {
+     public:
+        inline BloomFilter() = default;
+        inline explicit BloomFilter(size_t aExpectedNumberOfValues) : mWords(std::max(size_t{1}, (aExpectedNumberOfValues * BitsPerValue + WordBits - 1) / WordBits)) {}
+
+        inline void add(std::string_view aValue)
+            {
+                for_each_bit(aValue, [this](size_t aBit) { mWords[aBit / WordBits] |= Word{1} << (aBit % WordBits); });
+            }
+
+          // number of values the filter was made for, false positive rate grows if more values are added
+        inline size_t capacity() const { return mWords.size() * WordBits / BitsPerValue; }
+
+        inline bool may_contain(std::string_view aValue) const
+            {
+                if (mWords.empty())
+                    return true;
+                bool result = true;
+                for_each_bit(aValue, [this,&result](size_t aBit) { result &= (mWords[aBit / WordBits] & (Word{1} << (aBit % WordBits))) != 0; });
+                return result;
+            }
+
+     private:
+        using Word = uint64_t;
+        static constexpr const size_t WordBits = 64;
+        static constexpr const size_t BitsPerValue = 10;
+        static constexpr const size_t NumberOfHashes = 7;
+
+        std::vector<Word> mWords;
+
+          // double hashing: bit k is h1 + k * h2, h1 is FNV-1a, h2 is std::hash
+        template <typename Func> inline void for_each_bit(std::string_view aValue, Func aFunc) const
+            {
+                uint64_t h1 = 14695981039346656037ULL;
+                for (auto c: aValue)
+                    h1 = (h1 ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+                const uint64_t h2 = std::hash<std::string_view>{}(aValue) | 1;
+                const uint64_t number_of_bits = mWords.size() * WordBits;
+                for (size_t k = 0; k < NumberOfHashes; ++k)
+                    aFunc(static_cast<size_t>((h1 + k * h2) % number_of_bits));
+            }
+
+    }; // class BloomFilter
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -0,0 +1,167 @@
+#include "hidb-bitmap.hh"
+#include "hidb.hh"
+
+// ----------------------------------------------------------------------
+
+static inline std::string passage_type(const AntigenSerum& aAntigenSerum)
+{
+    if (aAntigenSerum.is_reassortant())
+        return "reassortant";
+    else if (aAntigenSerum.is_egg())
+        return "egg";
+    return "cell";
+}
+
+// ----------------------------------------------------------------------
+
+  // year of isolation date, if not available year from the name
+static inline std::string year(const hidb::AntigenSerumData<Antigen>& aAntigen)
+{
+    const auto date = aAntigen.date();
+    if (!date.empty())
+        return date.substr(0, 4);
+    try {
+        return virus_name::year(aAntigen.data().name());
+    }
+    catch (virus_name::Unrecognized&) {
+        return {};
+    }
+}
+
+static inline std::string year(const hidb::AntigenSerumData<Serum>& aSerum)
+{
+    try {
+        return virus_name::year(aSerum.data().name());
+    }
+    catch (virus_name::Unrecognized&) {
+        return {};
+    }
+}
+
+// ----------------------------------------------------------------------
+
+template <typename AS> void hidb::BitmapIndex::make(const HiDb& aHiDb, const std::vector<AS>& aData)
+{
+    mSize = aData.size();
+    mNone = Bitmap(mSize);
+    for (auto& dimension: mBitmaps)
+        dimension.clear();
+
+    for (size_t no = 0; no < aData.size(); ++no)
+        set_values(aHiDb, aData[no], no);
+
+} // hidb::BitmapIndex::make
+
+template void hidb::BitmapIndex::make<hidb::AntigenData>(const HiDb& aHiDb, const std::vector<AntigenData>& aData);
+template void hidb::BitmapIndex::make<hidb::SerumData>(const HiDb& aHiDb, const std::vector<SerumData>& aData);
+
+// ----------------------------------------------------------------------
+
+template <typename AS> void hidb::BitmapIndex::set_values(const HiDb& aHiDb, const AS& aEntry, size_t aNo)
+{
+    std::vector<std::string> labs;
+    aEntry.labs(aHiDb, labs);
+    for (const auto& lab: labs)
+        set(Lab, lab, aNo);
+    if (const auto lineage = aEntry.lineage(); !lineage.empty())
+        set(Lineage, lineage, aNo);
+    if (aEntry.in_hi_assay(aHiDb))
+        set(Assay, "HI", aNo);
+    if (aEntry.in_neut_assay(aHiDb))
+        set(Assay, "NEUT", aNo);
+    std::vector<std::string> virus_types;
+    for (const auto& pt: aEntry.per_table()) {
+        const auto virus_type = aHiDb.charts()[pt.table_id()].chart_info().virus_type();
+        if (std::find(virus_types.begin(), virus_types.end(), virus_type) == virus_types.end()) {
+            virus_types.push_back(virus_type);
+            set(VirusType, virus_type, aNo);
+        }
+    }
+    set(PassageType, passage_type(aEntry.data()), aNo);
+    if (const auto yr = year(aEntry); !yr.empty())
+        set(Year, yr, aNo);
+
+} // hidb::BitmapIndex::set_values
+
+// ----------------------------------------------------------------------
+
+void hidb::BitmapIndex::insert(const OrdinalShift& aShift)
+{
+    mSize += aShift.number_of_inserted();
+    mNone = Bitmap(mSize);
+    for (auto& dimension: mBitmaps) {
+        for (auto& [value, bitmap]: dimension)
+            bitmap = bitmap.shifted(aShift);
+    }
+
+} // hidb::BitmapIndex::insert
+
+// ----------------------------------------------------------------------
+
+template <typename AS> void hidb::BitmapIndex::update(const HiDb& aHiDb, const AS& aEntry, size_t aNo)
+{
+      // values may change (e.g. year when isolation date becomes known), old ones are removed
+    std::vector<std::pair<Dimension, std::string>> old_values;
+    for (size_t dimension = 0; dimension < DimensionSize; ++dimension) {
+        for (auto& [value, bitmap]: mBitmaps[dimension]) {
+            if (bitmap.test(aNo)) {
+                bitmap.reset(aNo);
+                old_values.emplace_back(static_cast<Dimension>(dimension), value);
+            }
+        }
+    }
+    set_values(aHiDb, aEntry, aNo);
+    for (const auto& [dimension, value]: old_values) {
+        if (const auto found = mBitmaps[dimension].find(value); !found->second.test(aNo) && !found->second.any())
+            mBitmaps[dimension].erase(found);
+    }
+
+} // hidb::BitmapIndex::update
+
+template void hidb::BitmapIndex::update<hidb::AntigenData>(const HiDb& aHiDb, const AntigenData& aEntry, size_t aNo);
+template void hidb::BitmapIndex::update<hidb::SerumData>(const HiDb& aHiDb, const SerumData& aEntry, size_t aNo);
+
+// ----------------------------------------------------------------------
+
+const hidb::Bitmap& hidb::BitmapIndex::get(Dimension aDimension, std::string aValue) const
+{
+    const auto found = mBitmaps[aDimension].find(aValue);
+    return found == mBitmaps[aDimension].end() ? mNone : found->second;
+
+} // hidb::BitmapIndex::get
+
+// ----------------------------------------------------------------------
+
+std::vector<std::string> hidb::BitmapIndex::values(Dimension aDimension) const
+{
+    std::vector<std::string> result;
+    std::transform(mBitmaps[aDimension].begin(), mBitmaps[aDimension].end(), std::back_inserter(result), [](const auto& entry) { return entry.first; });
+    return result;
+
+} // hidb::BitmapIndex::values
+
+// ----------------------------------------------------------------------
+
+hidb::BitmapIndex::Dimension hidb::BitmapIndex::dimension(std::string aName)
+{
+    if (aName == "lab")
+        return Lab;
+    else if (aName == "lineage")
+        return Lineage;
+    else if (aName == "assay")
+        return Assay;
+    else if (aName == "virus_type")
+        return VirusType;
+    else if (aName == "passage_type")
+        return PassageType;
+    else if (aName == "year")
+        return Year;
+    else
+        throw std::runtime_error("Unrecognized bitmap index dimension: " + aName);
+
+} // hidb::BitmapIndex::dimension
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+    class HiDb;
+
+// ----------------------------------------------------------------------
+
+      // maps ordinals before inserting entries to ordinals after it, aInserted are
+      // sorted ordinals of the inserted entries after inserting
+    class OrdinalShift
+    {
+     public:
+        inline OrdinalShift(const std::vector<size_t>& aInserted) : mOldBefore(aInserted.size())
+            {
+                for (size_t no = 0; no < aInserted.size(); ++no)
+                    mOldBefore[no] = aInserted[no] - no;
+            }
+
+        inline size_t number_of_inserted() const { return mOldBefore.size(); }
+        inline size_t operator()(size_t aOld) const { return aOld + static_cast<size_t>(std::upper_bound(mOldBefore.begin(), mOldBefore.end(), aOld) - mOldBefore.begin()); }
+
+     private:
+        std::vector<size_t> mOldBefore; // for each inserted entry: number of old entries before it
+
+    }; // class OrdinalShift
+
+// ----------------------------------------------------------------------
+
+      // set of antigen or serum ordinals (indices in HiDb::antigens() or HiDb::sera())
+    class Bitmap
+    {
+     public:
+        inline Bitmap() = default;
+        inline explicit Bitmap(size_t aSize, bool aValue = false) : mSize(aSize), mWords((aSize + WordBits - 1) / WordBits, aValue ? ~Word{0} : Word{0}) { clear_tail(); }
+
+        inline size_t size() const { return mSize; }
+        inline bool test(size_t aNo) const { return mWords[aNo / WordBits] & (Word{1} << (aNo % WordBits)); }
+        inline void set(size_t aNo) { mWords[aNo / WordBits] |= Word{1} << (aNo % WordBits); }
+        inline void reset(size_t aNo) { mWords[aNo / WordBits] &= ~(Word{1} << (aNo % WordBits)); }
+        inline size_t count() const { size_t result = 0; for (auto word: mWords) result += static_cast<size_t>(__builtin_popcountll(word)); return result; }
+        inline bool any() const { for (auto word: mWords) if (word) return true; return false; }
+
+        inline Bitmap& operator &= (const Bitmap& aNother) { check_size(aNother); for (size_t no = 0; no < mWords.size(); ++no) mWords[no] &= aNother.mWords[no]; return *this; }
+        inline Bitmap& operator |= (const Bitmap& aNother) { check_size(aNother); for (size_t no = 0; no < mWords.size(); ++no) mWords[no] |= aNother.mWords[no]; return *this; }
+        inline Bitmap operator ~ () const { Bitmap result(*this); for (auto& word: result.mWords) word = ~word; result.clear_tail(); return result; }
+
+          // calls aFunc(ordinal) for each set bit in increasing order
+        template <typename Func> inline void for_each(Func aFunc) const
+            {
+                for (size_t word_no = 0; word_no < mWords.size(); ++word_no) {
+                    for (Word word = mWords[word_no]; word; word &= word - 1)
+                        aFunc(word_no * WordBits + static_cast<size_t>(__builtin_ctzll(word)));
+                }
+            }
+
+          // the same ordinals after inserting entries, bits of the inserted entries are not set
+        inline Bitmap shifted(const OrdinalShift& aShift) const
+            {
+                Bitmap result(mSize + aShift.number_of_inserted());
+                for_each([&result,&aShift](size_t aNo) { result.set(aShift(aNo)); });
+                return result;
+            }
+
+     private:
+        using Word = uint64_t;
+        static constexpr const size_t WordBits = 64;
+
+        size_t mSize = 0;
+        std::vector<Word> mWords;
+
+        inline void clear_tail() { if (mSize % WordBits) mWords.back() &= (Word{1} << (mSize % WordBits)) - 1; }
+        inline void check_size(const Bitmap& aNother) const { if (aNother.mSize != mSize) throw std::runtime_error("Bitmap: size mismatch"); }
+
+    }; // class Bitmap
+
+    inline Bitmap operator & (Bitmap a, const Bitmap& b) { return a &= b; }
+    inline Bitmap operator | (Bitmap a, const Bitmap& b) { return a |= b; }
+
+// ----------------------------------------------------------------------
+
+      // for each dimension: value -> bitmap of antigens/sera having that value
+    class BitmapIndex
+    {
+     public:
+        enum Dimension : size_t { Lab, Lineage, Assay, VirusType, PassageType, Year, DimensionSize };
+
+        template <typename AS> void make(const HiDb& aHiDb, const std::vector<AS>& aData);
+          // used by HiDb::add(): makes room for inserted entries (see OrdinalShift), then sets bits of
+          // inserted and updated entries from their current values
+        void insert(const OrdinalShift& aShift);
+        template <typename AS> void update(const HiDb& aHiDb, const AS& aEntry, size_t aNo);
+
+        inline size_t size() const { return mSize; }
+        inline Bitmap all() const { return Bitmap(mSize, true); }
+          // returns bitmap with no bits set if value is not found
+        const Bitmap& get(Dimension aDimension, std::string aValue) const;
+        std::vector<std::string> values(Dimension aDimension) const;
+
+        static Dimension dimension(std::string aName); // "lab", "lineage", "assay", "virus_type", "passage_type", "year"
+
+     private:
+        size_t mSize = 0;
+        std::array<std::map<std::string, Bitmap>, DimensionSize> mBitmaps;
+        Bitmap mNone;
+
+        inline void set(Dimension aDimension, std::string aValue, size_t aNo) { mBitmaps[aDimension].try_emplace(aValue, mSize).first->second.set(aNo); }
+        template <typename AS> void set_values(const HiDb& aHiDb, const AS& aEntry, size_t aNo);
+
+    }; // class BitmapIndex
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
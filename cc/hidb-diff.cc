@@ -0,0 +1,77 @@
+#include <future>
+
+#include "acmacs-base/argc-argv.hh"
+#include "locationdb/locdb.hh"
+#include "hidb.hh"
+
+using namespace std::string_literals;
+
+// ----------------------------------------------------------------------
+
+constexpr const char* sUsage = " [options] <old-hidb.json.xz> <new-hidb.json.xz>\n  Lists tables, antigens and sera added (+), removed (-) and changed (~) in the new hidb.\n  Exit status is 0 if hidbs are the same, 1 if they differ, 2 on error.\n";
+
+static void report(std::string aWhat, const hidb::HiDbDiff::Changes& aChanges, bool aSummary);
+
+// ----------------------------------------------------------------------
+
+int main(int argc, char* const argv[])
+{
+    try {
+        argc_argv args(argc, argv, {
+                {"--summary", false},
+                {"--locdb", ""},
+                {"-v", false},
+                {"--verbose", false},
+                {"-h", false},
+                {"--help", false},
+            });
+        if (args["-h"] || args["--help"] || args.number_of_arguments() != 2) {
+            throw std::runtime_error("Usage: "s + args.program() + sUsage + args.usage_options());
+        }
+        const auto timer = (args["-v"] || args["--verbose"]) ? report_time::Yes : report_time::No;
+        const bool summary = args["--summary"];
+        const std::string locdb = args["--locdb"];
+        hidb::setup({}, locdb, timer == report_time::Yes);
+        get_locdb();            // load locdb before it is shared by the threads below
+
+        hidb::HiDb older, newer;
+        auto importing = std::async(std::launch::async, [&]() { older.importFrom(args[0], timer); });
+        newer.importFrom(args[1], timer);
+        importing.get();
+
+        Timeit timeit("DEBUG: diff: ", timer);
+        const auto diff = older.diff(newer);
+        timeit.report();
+        report("table", diff.tables, summary);
+        report("antigen", diff.antigens, summary);
+        report("serum", diff.sera, summary);
+        return diff.empty() ? 0 : 1;
+    }
+    catch (std::exception& err) {
+        std::cerr << "ERROR: " << err.what() << '\n';
+        return 2;
+    }
+}
+
+// ----------------------------------------------------------------------
+
+void report(std::string aWhat, const hidb::HiDbDiff::Changes& aChanges, bool aSummary)
+{
+    if (aSummary) {
+        std::cout << aWhat << ": +" << aChanges.added.size() << " -" << aChanges.removed.size() << " ~" << aChanges.changed.size() << '\n';
+    }
+    else {
+        for (const auto& key: aChanges.removed)
+            std::cout << "- " << aWhat << ' ' << key << '\n';
+        for (const auto& key: aChanges.added)
+            std::cout << "+ " << aWhat << ' ' << key << '\n';
+        for (const auto& key: aChanges.changed)
+            std::cout << "~ " << aWhat << ' ' << key << '\n';
+    }
+
+} // report
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -15,8 +15,12 @@ namespace json_writer
 namespace jsw = json_writer;
 
 template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::HiDb& aHiDb);
+template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::Tables& aTables);
 template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::ChartData& chart);
 template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::ChartData::AgSrRef& ref);
+template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::TiterMatrix& titers);
+template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::StatRecords& records);
+template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::StatCube& cube);
 
 #include "acmacs-base/json-writer.hh"
 
@@ -24,8 +28,9 @@ template <typename RW> jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, con
 
 template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::PerTable& per_table)
 {
+    const std::vector<std::string> lab_id(per_table.lab_id().begin(), per_table.lab_id().end());
     return writer << jsw::start_object << JsonKey::TableId << per_table.table_id() << jsw::if_not_empty(JsonKey::Date, per_table.date())
-                  << jsw::if_not_empty(JsonKey::LabId, per_table.lab_id()) << jsw::if_not_empty(JsonKey::HomologousAntigen, per_table.homologous()) << jsw::end_object;
+                  << jsw::if_not_empty(JsonKey::LabId, lab_id) << jsw::if_not_empty(JsonKey::HomologousAntigen, per_table.homologous()) << jsw::end_object;
 }
 
 // ----------------------------------------------------------------------
@@ -77,6 +82,51 @@ template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writ
 
 // ----------------------------------------------------------------------
 
+template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::TiterMatrix& titers)
+{
+    writer << jsw::start_array;
+    for (size_t ag_no = 0; ag_no < titers.number_of_antigens(); ++ag_no) {
+        writer << jsw::start_array;
+        for (size_t sr_no = 0; sr_no < titers.number_of_sera(); ++sr_no)
+            writer << titers.titer(ag_no, sr_no);
+        writer << jsw::end_array;
+    }
+    return writer << jsw::end_array;
+}
+
+// ----------------------------------------------------------------------
+
+template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::StatRecords& records)
+{
+    writer << jsw::start_array;
+    for (size_t record_no = 0; record_no < records.size(); ++record_no) {
+        writer << jsw::start_array << records.key(record_no);
+        for (size_t dim = 0; dim < hidb::StatRecords::DimensionSize; ++dim)
+            writer << records.value(record_no, static_cast<hidb::StatRecords::Dimension>(dim));
+        writer << jsw::end_array;
+    }
+    return writer << jsw::end_array;
+}
+
+// ----------------------------------------------------------------------
+
+template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::StatCube& cube)
+{
+    const auto& cells = cube.cells();
+    writer << jsw::start_array;
+    for (size_t cell_no = 0; cell_no < cells.size(); ++cell_no) {
+        if (cells.weight(cell_no)) {
+            writer << jsw::start_array << static_cast<int>(cells.weight(cell_no));
+            for (size_t dim = 0; dim < hidb::StatRecords::DimensionSize; ++dim)
+                writer << cells.value(cell_no, static_cast<hidb::StatRecords::Dimension>(dim));
+            writer << jsw::end_array;
+        }
+    }
+    return writer << jsw::end_array;
+}
+
+// ----------------------------------------------------------------------
+
 template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::ChartData& chart)
 {
     return writer << jsw::start_object
@@ -97,14 +147,26 @@ template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writ
 
 // ----------------------------------------------------------------------
 
+template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::Tables& aTables)
+{
+    writer << jsw::start_array;
+    for (const auto& chart: aTables)
+        writer << chart;
+    return writer << jsw::end_array;
+}
+
+// ----------------------------------------------------------------------
+
 template <typename RW> inline jsw::writer<RW>& operator <<(jsw::writer<RW>& writer, const hidb::HiDb& aHiDb)
 {
-    return writer << jsw::start_object
-                  << jsw::key("  version") << "hidb-v4"
-                  << JsonKey::Antigens << aHiDb.antigens()
-                  << JsonKey::Sera << aHiDb.sera()
-                  << JsonKey::Tables << aHiDb.charts()
-                  << jsw::end_object;
+    writer << jsw::start_object
+           << jsw::key("  version") << "hidb-v4"
+           << JsonKey::Antigens << aHiDb.antigens()
+           << JsonKey::Sera << aHiDb.sera()
+           << JsonKey::Tables << aHiDb.charts();
+    if (aHiDb.stat_records_made())
+        writer << JsonKey::Stat << jsw::start_object << JsonKey::Antigens << aHiDb.antigen_stat_records() << JsonKey::Sera << aHiDb.serum_stat_records() << JsonKey::StatCube << aHiDb.antigen_stat_cube() << jsw::end_object;
+    return writer << jsw::end_object;
 }
 
 // ----------------------------------------------------------------------
@@ -16,8 +16,9 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
     {
         Ignore, Init, Root, Version, // 0-3
         Antigens, Sera, Antigen, Serum, PerTableList, PerTable, // 4-9
-        Tables, Table, TableAntigens, TableAntigenList, TableSera, TableSerumList, TableAntigenSerumRef, TableTiters, TableTiterRows, // TableTiterRow, // 10-
-        StringField, StringListField,
+        Tables, Table, TableAntigens, TableAntigenList, TableSera, TableSerumList, TableAntigenSerumRef, TableTiters, TableTiterRows, TableTiterRow, // 10-
+        Stat, StatRecords, StatRecordList, StatRecord, StatCube, StatCubeList, StatCubeCell,
+        StringField, StringListField, InternedStringField, InternedStringListField,
     };
 
     union Arg
@@ -47,7 +48,7 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
           string_to_fill(nullptr),
             // bool_to_fill(nullptr), int_to_fill(nullptr), double_to_fill(nullptr),
           ag_sr_ref_to_fill(nullptr),
-          vector_string_to_fill(nullptr), antigen_to_fill(nullptr), serum_to_fill(nullptr), per_table_list(nullptr)
+          vector_string_to_fill(nullptr), interned_to_fill(nullptr), vector_interned_to_fill(nullptr), antigen_to_fill(nullptr), serum_to_fill(nullptr), per_table_list(nullptr), stat_records_to_fill(nullptr)
         { state.push(State::Init); }
 
     inline bool transit(char input, Arg arg = Arg())
@@ -90,9 +91,9 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
     inline bool String(const char* str, rapidjson::SizeType length, bool /*copy*/) { return transit(Tr::String, {str, length}); }
     inline bool Bool(bool b) { return transit(Tr::Bool, b); }
 
-    inline bool Int(int /*i*/) { return false; }
+    inline bool Int(int i) { return transit(Tr::Int, i); }
     bool Double(double /*d*/) { return false; }
-    // bool Uint(unsigned u) { return Int(static_cast<int>(u)); }
+    bool Uint(unsigned u) { return Int(static_cast<int>(u)); }
 
     inline bool Null() { std::cout << "Null()" << std::endl; return false; }
     bool Int64(int64_t i) { std::cout << "Int64(" << i << ")" << std::endl; return false; }
@@ -113,9 +114,14 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
     // double* double_to_fill;
     hidb::ChartData::AgSrRef* ag_sr_ref_to_fill;
     std::vector<std::string>* vector_string_to_fill;
+    hidb::InternedString* interned_to_fill;
+    std::vector<hidb::InternedString>* vector_interned_to_fill;
     hidb::AntigenData* antigen_to_fill;
     hidb::SerumData* serum_to_fill;
     std::vector<hidb::PerTable>* per_table_list;
+    hidb::StatRecords* stat_records_to_fill;
+    std::vector<std::string> stat_record; // key and values
+    int stat_cube_count;
 
       // ----------------------------------------------------------------------
 
@@ -173,10 +179,10 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
     bool serum_per_table(Arg) { state.push(State::PerTableList); per_table_list = &serum_to_fill->per_table(); return true; }
 
     bool per_table(Arg) { state.push(State::PerTable); per_table_list->emplace_back(); return true; }
-    bool per_table_id(Arg) { state.push(State::StringField); string_to_fill = &per_table_list->back().table_id(); return true; } // T
-    bool per_table_date(Arg) { state.push(State::StringField); string_to_fill = &per_table_list->back().date(); return true; } // D
-    bool per_table_lab(Arg) { state.push(State::StringListField); vector_string_to_fill = &per_table_list->back().lab_id(); return true; } // l
-    bool per_table_homologous(Arg) { state.push(State::StringField); string_to_fill = &per_table_list->back().homologous(); return true; } // h
+    bool per_table_id(Arg) { state.push(State::InternedStringField); interned_to_fill = &per_table_list->back().table_id_ref(); return true; } // T
+    bool per_table_date(Arg) { state.push(State::InternedStringField); interned_to_fill = &per_table_list->back().date_ref(); return true; } // D
+    bool per_table_lab(Arg) { state.push(State::InternedStringListField); vector_interned_to_fill = &per_table_list->back().lab_id_ref(); return true; } // l
+    bool per_table_homologous(Arg) { state.push(State::InternedStringField); interned_to_fill = &per_table_list->back().homologous_ref(); return true; } // h
 
       // ----------------------------------------------------------------------
 
@@ -201,7 +207,9 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
     bool start_table_serum(Arg) { state.push(State::TableAntigenSerumRef); auto& srs = mHiDb.charts().back().sera(); srs.emplace_back(); ag_sr_ref_to_fill = &srs.back(); return true; }
     bool start_table_titers(Arg) { state.push(State::TableTiters); return true; }
     bool start_table_titer_rows(Arg) { state.pop(); state.push(State::TableTiterRows); return true; }
-    bool start_table_titer_row(Arg) { state.push(State::StringListField); auto& titers = mHiDb.charts().back().titers(); titers.emplace_back(); vector_string_to_fill = &titers.back(); return true; }
+    bool start_table_titer_row(Arg) { state.push(State::TableTiterRow); return true; }
+    bool table_titer(Arg arg) { mHiDb.charts().back().titers().append({arg.mStr.str, arg.mStr.length}); return true; }
+    bool end_table_titer_row(Arg) { mHiDb.charts().back().titers().end_row(); state.pop(); return true; }
 
     bool table_ag_sr(Arg arg)
         {
@@ -220,6 +228,42 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
 
       // ----------------------------------------------------------------------
 
+    bool start_stat(Arg) { state.push(State::Stat); return true; }
+    bool start_stat_antigens(Arg) { state.push(State::StatRecords); stat_records_to_fill = &mHiDb.antigen_stat_records(); return true; }
+    bool start_stat_sera(Arg) { state.push(State::StatRecords); stat_records_to_fill = &mHiDb.serum_stat_records(); return true; }
+    bool start_stat_record_list(Arg) { state.pop(); state.push(State::StatRecordList); return true; }
+    bool start_stat_record(Arg) { state.push(State::StatRecord); stat_record.clear(); return true; }
+    bool stat_record_value(Arg arg) { stat_record.emplace_back(arg.mStr.str, arg.mStr.length); return true; }
+
+    bool end_stat_record(Arg)
+        {
+            if (stat_record.size() != hidb::StatRecords::DimensionSize + 1)
+                return false;
+            hidb::StatRecords::Values values;
+            std::move(stat_record.begin() + 1, stat_record.end(), values.begin());
+            stat_records_to_fill->put(stat_record.front(), values);
+            state.pop();
+            return true;
+        }
+
+    bool start_stat_cube(Arg) { state.push(State::StatCube); return true; }
+    bool start_stat_cube_list(Arg) { state.pop(); state.push(State::StatCubeList); return true; }
+    bool start_stat_cube_cell(Arg) { state.push(State::StatCubeCell); stat_record.clear(); stat_cube_count = 0; return true; }
+    bool stat_cube_count_value(Arg arg) { stat_cube_count = arg.mInt; return true; }
+
+    bool end_stat_cube_cell(Arg)
+        {
+            if (stat_record.size() != hidb::StatRecords::DimensionSize)
+                return false;
+            hidb::StatRecords::Values values;
+            std::move(stat_record.begin(), stat_record.end(), values.begin());
+            mHiDb.antigen_stat_cube().adjust(values, stat_cube_count);
+            state.pop();
+            return true;
+        }
+
+      // ----------------------------------------------------------------------
+
     bool version(Arg arg)
         {
             if (std::memcmp(arg.mStr.str, "hidb-v4", arg.mStr.length))
@@ -242,6 +286,19 @@ class HiDbReaderEventHandler : public rapidjson::BaseReaderHandler<rapidjson::UT
             return true;
         }
 
+    bool interned_assign(Arg arg)
+        {
+            *interned_to_fill = std::string_view(arg.mStr.str, arg.mStr.length);
+            state.pop();
+            return true;
+        }
+
+    bool interned_append(Arg arg)
+        {
+            vector_interned_to_fill->emplace_back(std::string_view(arg.mStr.str, arg.mStr.length));
+            return true;
+        }
+
       // ----------------------------------------------------------------------
 
     static const Ptr transition[][62];
@@ -257,34 +314,44 @@ constexpr static H::Ptr N = &H::nope;
 constexpr static H::Ptr F = &H::fail;
 
 const HiDbReaderEventHandler::Ptr HiDbReaderEventHandler::transition[][62] = {
-      //      A,               B, C, D,                  E, F, G, H, I,            J, K, L,                   M, N,                O, P,                   Q, R,                       S, T,                     U, V,                    W, X, Y, Z, [,                            \ (int),    ],              ^ (bool),   _ (str),         `, a,                        b, c, d, e, f, g, h,                        i, j, k, l,                 m, n, o, p, q, r,             s,                    t,                      u, v,               w, x, y, z, {,                 | (double), },              ~ (version)
-/*Ignore*/   {N,               N, N, N,                  N, N, N, N, N,            N, N, N,                   N, N,                N, N,                   N, N,                       N, N,                     N, N,                    N, N, N, N, &H::push_ignore,              &H::ignore, &H::pop_ignore, &H::ignore, &H::ignore,      F, N,                        N, N, N, N, N, N, N,                        N, N, N, N,                 N, N, N, N, N, N,             N,                    N,                      N, N,               N, N, N, N, &H::push_ignore,   &H::ignore, &H::pop_ignore, N}, // Ignore
-/*Init*/     {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, F,                            F,          F,              F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_hidb,    F,          F,              F}, // Init
-/*Root*/     {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, F,                            F,          F,              F,          &H::push_ignore, F, &H::start_antigens,       F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             &H::start_sera,       &H::start_tables,       F, F,               F, F, F, F, F,                 F,          &H::pop,        &H::start_version}, // Root
-/*Version*/  {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, F,                            F,          F,              F,          &H::version,     F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // Version
-
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, N,                            F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_antigen, F,          F,              F}, // Antigens
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, N,                            F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_serum,   F,          F,              F}, // Sera
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, &H::antigen_lineage, F, &H::antigen_name, F, &H::antigen_passage, F, &H::antigen_reassortant, F, &H::antigen_per_table, F, F,                    F, F, F, F, F,                            F,          F,              F,          F,               F, &H::antigen_annotations,  F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          &H::pop,        F}, // Antigen
-             {F,               F, F, F,                  F, F, F, F, &H::serum_id, F, F, &H::serum_lineage,   F, &H::serum_name,   F, &H::serum_passage,   F, &H::serum_reassortant,   F, &H::serum_per_table,   F, F,                    F, F, F, F, F,                            F,          F,              F,          F,               F, &H::serum_annotations,    F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             &H::serum_species,    F,                      F, F,               F, F, F, F, F,                 F,          &H::pop,        F}, // Serum
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, N,                            F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::per_table,     F,          F,              F}, // PerTableList
-             {F,               F, F, &H::per_table_date, F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, &H::per_table_id,      F, F,                    F, F, F, F, F,                            F,          F,              F,          F,               F, F,                        F, F, F, F, F, F, &H::per_table_homologous, F, F, F, &H::per_table_lab, F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          &H::pop,        F}, // PerTable
-
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, N,                            F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_table,   F,          F,              F}, // Tables
-             {&H::table_assay, F, F, &H::table_date,     F, F, F, F, F,            F, F, F,                   F, &H::table_name,   F, F,                   F, F,                       F, &H::table_table_id,    F, &H::table_virus_type, F, F, F, F, F,                            F,          F,              F,          F,               F, &H::start_table_antigens, F, F, F, F, F, F, F,                        F, F, F, &H::table_lab,     F, F, F, F, F, &H::table_rbc, &H::start_table_sera, &H::start_table_titers, F, &H::table_virus, F, F, F, F, F,                 F,          &H::pop,        F}, // Table
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, &H::start_table_antigen_list, F,          F,              F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableAntigens
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, &H::start_table_antigen,      F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableAntigenList
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, &H::start_table_serum_list,   F,          F,              F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableSera
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, &H::start_table_serum,        F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableSerumList
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, F,                            F,          &H::pop,        F,          &H::table_ag_sr, F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableAntigenSerumRef
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, &H::start_table_titer_rows,   F,          F,              F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableTiters
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, &H::start_table_titer_row,    F,          &H::pop,        F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // TableTiterRows
-               //               {F, F, F                 , F, F, F, F, F           , F, F, F                  , F, F, F,                F                  , F, F                      , F, F, F,                     F                   , F, F, F, F, F, F,                            F,          &H::pop,        F,          &H::str_append,  F, F,                        F, F, F, F, F, F                       , F, F, F, F                , F, F, F, F, F, F            , F, F,                    F,                      F              , F, F, F, F, F, F,                 F,          F,              F}, // TableTiterRow
-
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, F,                            F,          F,              F,          &H::str_assign,  F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // StringField
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, N,                            F,          &H::pop,        F,          &H::str_append,  F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // StringListField
-
-             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F, F,                     F, F,                    F, F, F, F, F,                            F,          F,              F,          F,               F, F,                        F, F, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F}, // Last
+      //      A,               B, C, D,                  E, F, G, H, I,            J, K, L,                   M, N,                O, P,                   Q, R,                       S,              T,                     U, V,                    W, X, Y, Z, [,                            \ (int),                   ],                       ^ (bool),   _ (str),               `, a,                        b, c,                   d, e, f, g, h,                        i, j, k, l,                 m, n, o, p, q, r,             s,                    t,                      u, v,               w, x, y, z, {,                 | (double), },              ~ (version)      
+/*Ignore*/   {N,               N, N, N,                  N, N, N, N, N,            N, N, N,                   N, N,                N, N,                   N, N,                       N,              N,                     N, N,                    N, N, N, N, &H::push_ignore,              &H::ignore,                &H::pop_ignore,          &H::ignore, &H::ignore,            F, N,                        N, N,                   N, N, N, N, N,                        N, N, N, N,                 N, N, N, N, N, N,             N,                    N,                      N, N,               N, N, N, N, &H::push_ignore,   &H::ignore, &H::pop_ignore, N                }, // Ignore
+/*Init*/     {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_hidb,    F,          F,              F                }, // Init
+/*Root*/     {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       &H::start_stat, F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          &H::push_ignore,       F, &H::start_antigens,       F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             &H::start_sera,       &H::start_tables,       F, F,               F, F, F, F, F,                 F,          &H::pop,        &H::start_version}, // Root
+/*Version*/  {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          &H::version,           F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // Version
+
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, N,                            F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_antigen, F,          F,              F                }, // Antigens
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, N,                            F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_serum,   F,          F,              F                }, // Sera
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, &H::antigen_lineage, F, &H::antigen_name, F, &H::antigen_passage, F, &H::antigen_reassortant, F,              &H::antigen_per_table, F, F,                    F, F, F, F, F,                            F,                         F,                       F,          F,                     F, &H::antigen_annotations,  F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          &H::pop,        F                }, // Antigen
+             {F,               F, F, F,                  F, F, F, F, &H::serum_id, F, F, &H::serum_lineage,   F, &H::serum_name,   F, &H::serum_passage,   F, &H::serum_reassortant,   F,              &H::serum_per_table,   F, F,                    F, F, F, F, F,                            F,                         F,                       F,          F,                     F, &H::serum_annotations,    F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             &H::serum_species,    F,                      F, F,               F, F, F, F, F,                 F,          &H::pop,        F                }, // Serum
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, N,                            F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::per_table,     F,          F,              F                }, // PerTableList
+             {F,               F, F, &H::per_table_date, F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              &H::per_table_id,      F, F,                    F, F, F, F, F,                            F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, &H::per_table_homologous, F, F, F, &H::per_table_lab, F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          &H::pop,        F                }, // PerTable
+
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, N,                            F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, &H::start_table,   F,          F,              F                }, // Tables
+             {&H::table_assay, F, F, &H::table_date,     F, F, F, F, F,            F, F, F,                   F, &H::table_name,   F, F,                   F, F,                       F,              &H::table_table_id,    F, &H::table_virus_type, F, F, F, F, F,                            F,                         F,                       F,          F,                     F, &H::start_table_antigens, F, F,                   F, F, F, F, F,                        F, F, F, &H::table_lab,     F, F, F, F, F, &H::table_rbc, &H::start_table_sera, &H::start_table_titers, F, &H::table_virus, F, F, F, F, F,                 F,          &H::pop,        F                }, // Table
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_table_antigen_list, F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableAntigens
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_table_antigen,      F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableAntigenList
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_table_serum_list,   F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableSera
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_table_serum,        F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableSerumList
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         &H::pop,                 F,          &H::table_ag_sr,       F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableAntigenSerumRef
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_table_titer_rows,   F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableTiters
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_table_titer_row,    F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableTiterRows
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         &H::end_table_titer_row, F,          &H::table_titer,       F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // TableTiterRow
+
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          F,                     F, &H::start_stat_antigens,  F, &H::start_stat_cube, F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             &H::start_stat_sera,  F,                      F, F,               F, F, F, F, N,                 F,          &H::pop,        F                }, // Stat
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_stat_record_list,   F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StatRecords
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_stat_record,        F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StatRecordList
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         &H::end_stat_record,     F,          &H::stat_record_value, F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StatRecord
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_stat_cube_list,     F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StatCube
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, &H::start_stat_cube_cell,     F,                         &H::pop,                 F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StatCubeList
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            &H::stat_cube_count_value, &H::end_stat_cube_cell,  F,          &H::stat_record_value, F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StatCubeCell
+
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          &H::str_assign,        F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StringField
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, N,                            F,                         &H::pop,                 F,          &H::str_append,        F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // StringListField
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          &H::interned_assign,   F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // InternedStringField
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, N,                            F,                         &H::pop,                 F,          &H::interned_append,   F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // InternedStringListField
+
+             {F,               F, F, F,                  F, F, F, F, F,            F, F, F,                   F, F,                F, F,                   F, F,                       F,              F,                     F, F,                    F, F, F, F, F,                            F,                         F,                       F,          F,                     F, F,                        F, F,                   F, F, F, F, F,                        F, F, F, F,                 F, F, F, F, F, F,             F,                    F,                      F, F,               F, F, F, F, F,                 F,          F,              F                }, // Last
 };
 
 // ----------------------------------------------------------------------
@@ -0,0 +1,161 @@
+#include <cstdlib>
+#include <ctime>
+#include <future>
+#include <glob.h>
+
+#include "acmacs-base/argc-argv.hh"
+#include "locationdb/locdb.hh"
+#include "hidb.hh"
+
+using namespace std::string_literals;
+
+// ----------------------------------------------------------------------
+
+constexpr const char* sUsage = " [options]\n  Writes stat of all hidb4.*.json.xz found in db-dir for SSM report (same json as bin/hidb-stat-for-ssm-report)\n";
+
+struct Stat
+{
+    hidb::HiDbStat antigens, sera, sera_unique;
+};
+
+static std::vector<std::string> hidb_files(std::string aDbDir);
+static Stat make_stat(std::string aFilename, std::string aStart, std::string aEnd, bool aVerbose);
+static std::string today();
+template <typename Map> static void write_json(std::ostream& out, const Map& aMap, size_t aIndent);
+
+// ----------------------------------------------------------------------
+
+int main(int argc, char* const argv[])
+{
+    try {
+        argc_argv args(argc, argv, {
+                {"--db-dir", ""},
+                {"--start", ""},
+                {"--end", ""},
+                {"-v", false},
+                {"--verbose", false},
+                {"-h", false},
+                {"--help", false},
+            });
+        if (args["-h"] || args["--help"] || args.number_of_arguments() != 0) {
+            throw std::runtime_error("Usage: "s + args.program() + sUsage + args.usage_options());
+        }
+        const bool verbose = args["-v"] || args["--verbose"];
+        std::string db_dir = args["--db-dir"];
+        if (db_dir.empty()) {
+            if (const char* root = std::getenv("ACMACSD_ROOT"); root)
+                db_dir = root + "/data"s;
+            else
+                throw std::runtime_error("--db-dir not specified and ACMACSD_ROOT not set");
+        }
+        hidb::setup(db_dir, {}, verbose);
+        get_locdb();            // load locdb before it is shared by the threads below
+
+        const std::string start = args["--start"], end = args["--end"];
+        const auto filenames = hidb_files(db_dir);
+        if (filenames.empty())
+            throw std::runtime_error("No hidb4.*.json.xz found in " + db_dir);
+        std::vector<std::future<Stat>> stats;
+        for (const auto& filename: filenames)
+            stats.push_back(std::async(std::launch::async, make_stat, filename, start, end, verbose));
+
+        Stat total;
+        for (auto& stat_future: stats) {
+            const auto stat = stat_future.get();
+            total.antigens.add(stat.antigens);
+            total.sera.add(stat.sera);
+            total.sera_unique.add(stat.sera_unique);
+        }
+        total.antigens.compute_totals();
+        total.sera.compute_totals();
+        total.sera_unique.compute_totals();
+
+        std::cout << "{\n \"antigens\": ";
+        write_json(std::cout, total.antigens, 1);
+        std::cout << ",\n \"date\": \"" << today() << "\",\n \"sera\": ";
+        write_json(std::cout, total.sera, 1);
+        std::cout << ",\n \"sera_unique\": ";
+        write_json(std::cout, total.sera_unique, 1);
+        std::cout << "\n}\n";
+
+        return 0;
+    }
+    catch (std::exception& err) {
+        std::cerr << "ERROR: " << err.what() << '\n';
+        return 1;
+    }
+}
+
+// ----------------------------------------------------------------------
+
+std::vector<std::string> hidb_files(std::string aDbDir)
+{
+    std::vector<std::string> result;
+    glob_t found;
+    if (glob((aDbDir + "/hidb4.*.json.xz").c_str(), 0, nullptr, &found) == 0) {
+        for (size_t no = 0; no < found.gl_pathc; ++no)
+            result.emplace_back(found.gl_pathv[no]);
+    }
+    globfree(&found);
+    return result;
+
+} // hidb_files
+
+// ----------------------------------------------------------------------
+
+Stat make_stat(std::string aFilename, std::string aStart, std::string aEnd, bool aVerbose)
+{
+    hidb::HiDb hidb;
+    hidb.importFrom(aFilename, aVerbose ? report_time::Yes : report_time::No);
+    Timeit timeit("DEBUG: stat " + aFilename + ": ", aVerbose ? report_time::Yes : report_time::No);
+    hidb.prepare_stat();
+    Stat result;
+    auto antigens = std::async(std::launch::async, [&]() { hidb.stat_antigens(result.antigens, aStart, aEnd); });
+    hidb.stat_sera(result.sera, &result.sera_unique, aStart, aEnd);
+    antigens.get();
+    return result;
+
+} // make_stat
+
+// ----------------------------------------------------------------------
+
+std::string today()
+{
+    const std::time_t now = std::time(nullptr);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", std::localtime(&now));
+    return buffer;
+
+} // today
+
+// ----------------------------------------------------------------------
+
+  // the same layout as python json.dumps(indent=1, sort_keys=True), maps are sorted by key
+static inline void write_json(std::ostream& out, size_t aValue, size_t /*aIndent*/)
+{
+    out << aValue;
+}
+
+template <typename Map> void write_json(std::ostream& out, const Map& aMap, size_t aIndent)
+{
+    if (aMap.empty()) {
+        out << "{}";
+        return;
+    }
+    out << "{\n";
+    bool first = true;
+    for (const auto& [key, value]: aMap) {
+        if (!first)
+            out << ",\n";
+        first = false;
+        out << std::string(aIndent + 1, ' ') << '"' << key << "\": ";
+        write_json(out, value, aIndent + 1);
+    }
+    out << '\n' << std::string(aIndent, ' ') << '}';
+
+} // write_json
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
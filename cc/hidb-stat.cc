@@ -0,0 +1,220 @@
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+#include "hidb-stat.hh"
+
+// ----------------------------------------------------------------------
+
+size_t hidb::StatRecords::put(std::string aKey, const Values& aValues, size_t aWeight)
+{
+    const auto [found, inserted] = mRecordOfKey.try_emplace(aKey, mKeys.size());
+    const size_t record_no = found->second;
+    if (inserted) {
+        mKeys.push_back(aKey);
+        mWeights.push_back(0);
+        mCodes.resize(mCodes.size() + DimensionSize);
+    }
+    set_weight(record_no, aWeight);
+    for (size_t dim = 0; dim < DimensionSize; ++dim)
+        mCodes[record_no * DimensionSize + dim] = mDictionaries[dim].code(aValues[dim]); // previous value remains in dictionary, it is skipped by GroupBy if not used
+    return record_no;
+
+} // hidb::StatRecords::put
+
+// ----------------------------------------------------------------------
+
+hidb::Bitmap hidb::StatRecords::select(Dimension aDimension, std::function<bool (const std::string&)> aPredicate) const
+{
+    const auto& values = mDictionaries[aDimension].values();
+    std::vector<char> accepted(values.size());
+    std::transform(values.begin(), values.end(), accepted.begin(), [&aPredicate](const auto& value) -> char { return aPredicate(value); });
+    Bitmap result(size());
+    for (size_t record_no = 0; record_no < size(); ++record_no) {
+        if (accepted[code(record_no, aDimension)])
+            result.set(record_no);
+    }
+    return result;
+
+} // hidb::StatRecords::select
+
+// ----------------------------------------------------------------------
+
+hidb::StatRecords::Dimension hidb::StatRecords::dimension(std::string aName)
+{
+    if (aName == "virus_type")
+        return VirusType;
+    else if (aName == "lineage")
+        return Lineage;
+    else if (aName == "lab")
+        return Lab;
+    else if (aName == "year_month")
+        return YearMonth;
+    else if (aName == "continent")
+        return Continent;
+    else if (aName == "country")
+        return Country;
+    else if (aName == "assay")
+        return Assay;
+    else
+        throw std::runtime_error("Unrecognized stat dimension: " + aName);
+
+} // hidb::StatRecords::dimension
+
+// ----------------------------------------------------------------------
+
+hidb::GroupBy::GroupBy(const StatRecords& aRecords, const std::vector<StatRecords::Dimension>& aDimensions, const Bitmap& aSelected, bool aWeighted)
+    : mRecords(aRecords), mDimensions(aDimensions)
+{
+    const size_t number_of_records = mRecords.size();
+    const size_t partitions = std::max(size_t{1}, std::min(static_cast<size_t>(std::thread::hardware_concurrency()), number_of_records / MinRecordsPerPartition));
+
+      // each partition has its own dense array, all of them together are limited by MaxDenseCounters
+    uint64_t combinations = 1;
+    for (auto dimension: mDimensions) {
+        combinations *= std::max(mRecords.dictionary(dimension).size(), size_t{1});
+        if (combinations > MaxDenseCounters)
+            break;
+    }
+    const bool dense = combinations * partitions <= MaxDenseCounters;
+
+    auto index = [this](size_t aRecordNo) -> uint64_t {
+        uint64_t result = 0;
+        for (auto dimension: mDimensions)
+            result = result * mRecords.dictionary(dimension).size() + mRecords.code(aRecordNo, dimension);
+        return result;
+    };
+
+    struct Partial
+    {
+        std::vector<size_t> dense;
+        std::unordered_map<uint64_t, size_t> sparse;
+    };
+
+    auto count = [&](size_t aFirst, size_t aLast) -> Partial {
+        Partial partial;
+        if (dense)
+            partial.dense.resize(combinations);
+        for (size_t record_no = aFirst; record_no < aLast; ++record_no) {
+            if (aSelected.test(record_no)) {
+                const size_t increment = aWeighted ? mRecords.weight(record_no) : 1;
+                if (dense)
+                    partial.dense[index(record_no)] += increment;
+                else
+                    partial.sparse[index(record_no)] += increment;
+            }
+        }
+        return partial;
+    };
+
+    const size_t partition_size = (number_of_records + partitions - 1) / partitions;
+    std::vector<std::future<Partial>> futures;
+    for (size_t first = partition_size; first < number_of_records; first += partition_size)
+        futures.push_back(std::async(std::launch::async, count, first, std::min(first + partition_size, number_of_records)));
+    auto result = count(0, std::min(partition_size, number_of_records)); // first partition in this thread
+    for (auto& future: futures) {
+        const auto partial = future.get();
+        if (dense)
+            std::transform(result.dense.begin(), result.dense.end(), partial.dense.begin(), result.dense.begin(), std::plus<size_t>{});
+        else
+            for (const auto& [key, value]: partial.sparse)
+                result.sparse[key] += value;
+    }
+    mDense = std::move(result.dense);
+    mSparse = std::move(result.sparse);
+
+} // hidb::GroupBy::GroupBy
+
+// ----------------------------------------------------------------------
+
+hidb::GroupBy::Key hidb::GroupBy::key(uint64_t aIndex) const
+{
+    Key result(mDimensions.size());
+    for (size_t dim_no = mDimensions.size(); dim_no > 0; --dim_no) {
+        const auto& dictionary = mRecords.dictionary(mDimensions[dim_no - 1]);
+        result[dim_no - 1] = dictionary[static_cast<StatRecords::Code>(aIndex % dictionary.size())];
+        aIndex /= dictionary.size();
+    }
+    return result;
+
+} // hidb::GroupBy::key
+
+// ----------------------------------------------------------------------
+
+void hidb::GroupBy::for_each(std::function<void (const Key&, size_t)> aFunc) const
+{
+    for (uint64_t index = 0; index < mDense.size(); ++index) {
+        if (mDense[index])
+            aFunc(key(index), mDense[index]);
+    }
+    for (const auto& [index, count]: mSparse) {
+        if (count)              // records of zero weight
+            aFunc(key(index), count);
+    }
+
+} // hidb::GroupBy::for_each
+
+// ----------------------------------------------------------------------
+
+std::map<hidb::GroupBy::Key, size_t> hidb::GroupBy::counts() const
+{
+    std::map<Key, size_t> result;
+    for_each([&result](const Key& aKey, size_t aCount) { result.emplace(aKey, aCount); });
+    return result;
+
+} // hidb::GroupBy::counts
+
+// ----------------------------------------------------------------------
+
+void hidb::StatCube::make(const StatRecords& aRecords, bool aWeighted)
+{
+    std::vector<StatRecords::Dimension> dimensions;
+    for (size_t dim = 0; dim < StatRecords::DimensionSize; ++dim)
+        dimensions.push_back(static_cast<StatRecords::Dimension>(dim));
+    mCells.clear();
+    GroupBy(aRecords, dimensions, aRecords.all(), aWeighted).for_each([this](const GroupBy::Key& aKey, size_t aCount) {
+        StatRecords::Values values;
+        std::copy(aKey.begin(), aKey.end(), values.begin());
+        adjust(values, static_cast<long>(aCount));
+    });
+
+} // hidb::StatCube::make
+
+// ----------------------------------------------------------------------
+
+void hidb::StatCube::adjust(const StatRecords::Values& aValues, long aDelta)
+{
+    std::string key;
+    for (const auto& value: aValues)
+        key.append(value).append(1, '\x1F');
+    if (const auto record_no = mCells.find(key); record_no != StatRecords::NotFound)
+        mCells.set_weight(record_no, static_cast<size_t>(std::max(static_cast<long>(mCells.weight(record_no)) + aDelta, 0L)));
+    else if (aDelta > 0)
+        mCells.put(key, aValues, static_cast<size_t>(aDelta));
+
+} // hidb::StatCube::adjust
+
+// ----------------------------------------------------------------------
+
+std::map<hidb::GroupBy::Key, size_t> hidb::StatCube::slice(const std::vector<StatRecords::Dimension>& aDimensions, const Filter& aFilter, std::string aStart, std::string aEnd) const
+{
+    Bitmap selected = mCells.all();
+    for (const auto& [dimension, accepted]: aFilter)
+        selected &= mCells.select(dimension, [&accepted=accepted](const std::string& value) { return accepted.find(value) != accepted.end(); });
+    if (!aStart.empty() || !aEnd.empty()) {
+        auto year_month = [](std::string date) { date.erase(std::remove(date.begin(), date.end(), '-'), date.end()); return date.substr(0, 6); };
+        aStart = year_month(aStart);
+        aEnd = year_month(aEnd);
+        selected &= mCells.select(StatRecords::YearMonth, [&aStart, &aEnd](const std::string& value) {
+            return !value.empty() && (aStart.empty() || value >= aStart) && (aEnd.empty() || value < aEnd);
+        });
+    }
+    return GroupBy(mCells, aDimensions, selected, true).counts();
+
+} // hidb::StatCube::slice
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+#include "hidb-bitmap.hh"
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+      // distinct values of a dimension, code is an index in values
+    class Dictionary
+    {
+     public:
+        using Code = uint32_t;
+
+        inline Code code(std::string aValue)
+            {
+                const auto [found, inserted] = mCodes.try_emplace(aValue, static_cast<Code>(mValues.size()));
+                if (inserted)
+                    mValues.push_back(aValue);
+                return found->second;
+            }
+
+        inline const std::string& operator[](Code aCode) const { return mValues[aCode]; }
+        inline size_t size() const { return mValues.size(); }
+        inline const std::vector<std::string>& values() const { return mValues; }
+        inline void clear() { mValues.clear(); mCodes.clear(); }
+
+     private:
+        std::vector<std::string> mValues;
+        std::unordered_map<std::string, Code> mCodes;
+
+    }; // class Dictionary
+
+// ----------------------------------------------------------------------
+
+      // Dictionary encoded records used by stat, record per antigen or serum name (key).
+      // Weight of a record is the number of antigens/sera it stands for.
+      // Empty value of a dimension means unknown.
+      // Virus type, lab and assay are of one table: the first table of the first
+      // antigen/serum (in hidb order) with the name, as stat_antigens() always
+      // counted, a name titrated by several labs or in several assays is counted
+      // once under that table, not under each of its labs/assays.
+    class StatRecords
+    {
+     public:
+        enum Dimension : size_t { VirusType, Lineage, Lab /* of the first table */, YearMonth, Continent, Country, Assay /* of the first table */, DimensionSize };
+        using Code = Dictionary::Code;
+        using Values = std::array<std::string, DimensionSize>;
+        static constexpr const size_t NotFound = static_cast<size_t>(-1);
+
+        inline size_t size() const { return mKeys.size(); }
+        inline bool empty() const { return mKeys.empty(); }
+        inline const std::string& key(size_t aRecordNo) const { return mKeys[aRecordNo]; }
+        inline size_t find(std::string aKey) const { const auto found = mRecordOfKey.find(aKey); return found == mRecordOfKey.end() ? NotFound : found->second; }
+        inline size_t weight(size_t aRecordNo) const { return mWeights[aRecordNo]; }
+        inline void set_weight(size_t aRecordNo, size_t aWeight) { mWeights[aRecordNo] = static_cast<uint32_t>(aWeight); }
+        inline Code code(size_t aRecordNo, Dimension aDimension) const { return mCodes[aRecordNo * DimensionSize + aDimension]; }
+        inline const std::string& value(size_t aRecordNo, Dimension aDimension) const { return mDictionaries[aDimension][code(aRecordNo, aDimension)]; }
+        inline const Dictionary& dictionary(Dimension aDimension) const { return mDictionaries[aDimension]; }
+        inline Values values(size_t aRecordNo) const { Values result; for (size_t dim = 0; dim < DimensionSize; ++dim) result[dim] = value(aRecordNo, static_cast<Dimension>(dim)); return result; }
+
+          // adds record for aKey or replaces values and weight of the existing one, returns record number
+        size_t put(std::string aKey, const Values& aValues, size_t aWeight = 1);
+        inline void clear() { mKeys.clear(); mRecordOfKey.clear(); mWeights.clear(); mCodes.clear(); for (auto& dictionary: mDictionaries) dictionary.clear(); }
+
+        inline Bitmap all() const { return Bitmap(size(), true); }
+          // records with value of aDimension satisfying aPredicate, aPredicate is called once per distinct value
+        Bitmap select(Dimension aDimension, std::function<bool (const std::string&)> aPredicate) const;
+
+        static Dimension dimension(std::string aName); // "virus_type", "lineage", "lab", "year_month", "continent", "country", "assay"
+
+     private:
+        std::array<Dictionary, DimensionSize> mDictionaries;
+        std::vector<std::string> mKeys;
+        std::unordered_map<std::string, size_t> mRecordOfKey;
+        std::vector<uint32_t> mWeights;
+        std::vector<Code> mCodes;   // DimensionSize codes per record
+
+    }; // class StatRecords
+
+// ----------------------------------------------------------------------
+
+      // Number of selected records (sum of their weights if aWeighted) for each combination of values of the passed dimensions.
+      // Records are split into partitions counted concurrently, combination of codes is
+      // a mixed radix index in a dense array (or in a hash table if there are too many combinations).
+    class GroupBy
+    {
+     public:
+        using Key = std::vector<std::string>;
+
+        GroupBy(const StatRecords& aRecords, const std::vector<StatRecords::Dimension>& aDimensions, const Bitmap& aSelected, bool aWeighted = false);
+
+          // aFunc(key, count) for combinations having non-zero count, key has values in order of dimensions passed to constructor
+        void for_each(std::function<void (const Key&, size_t)> aFunc) const;
+        std::map<Key, size_t> counts() const;
+
+     private:
+        const StatRecords& mRecords;
+        std::vector<StatRecords::Dimension> mDimensions;
+        std::vector<size_t> mDense;
+        std::unordered_map<uint64_t, size_t> mSparse;
+
+        static constexpr const uint64_t MaxDenseCounters = 1 << 20; // in all partitions, above it counters are in the hash table
+        static constexpr const size_t MinRecordsPerPartition = 4096;
+
+        Key key(uint64_t aIndex) const;
+
+    }; // class GroupBy
+
+// ----------------------------------------------------------------------
+
+      // Number of records (sum of weights) for each combination of values of
+      // all dimensions. Made from stat records and updated together with them,
+      // antigen cube is stored with hidb. Slicing and rolling up uses cells only,
+      // i.e. it does not depend on the number of antigens.
+    class StatCube
+    {
+     public:
+        using Filter = std::map<StatRecords::Dimension, std::set<std::string>>; // dimension -> accepted values
+
+          // if aWeighted, record adds its weight to the cell, otherwise 1
+        void make(const StatRecords& aRecords, bool aWeighted = true);
+          // changes count of the cell, used when record is replaced and by import
+        void adjust(const StatRecords::Values& aValues, long aDelta);
+
+        inline bool empty() const { return mCells.empty(); }
+        inline const StatRecords& cells() const { return mCells; } // weight of a cell is its count, it may be 0
+
+          // Counts for each combination of values of aDimensions (other dimensions are rolled up) among cells accepted by aFilter
+          // and having year-month in [aStart, aEnd), empty means unlimited, cells without year-month are accepted only if range is unlimited.
+        std::map<GroupBy::Key, size_t> slice(const std::vector<StatRecords::Dimension>& aDimensions, const Filter& aFilter, std::string aStart, std::string aEnd) const;
+
+     private:
+        StatRecords mCells;
+
+    }; // class StatCube
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -1,7 +1,10 @@
 #include <iomanip>
+#include <set>
 #include <regex>
 #include <cctype>
 #include <typeinfo>
+#include <mutex>
+#include <future>
 
 #include "acmacs-base/timeit.hh"
 #include "acmacs-base/stream.hh"
@@ -27,23 +30,61 @@ ChartData::ChartData(const Chart& aChart)
     for (const auto& serum: aChart.sera()) {
         mSera.emplace_back(serum.name(), variant_id(serum));
     }
+    make_index();
 }
 
 // ----------------------------------------------------------------------
 
-size_t ChartData::antigen_index_by_full_name(std::string full_name) const
+void ChartData::make_index()
 {
-      // std::cerr << full_name << std::endl;
-    size_t result = static_cast<size_t>(-1); // not found
-    for (auto ap = mAntigens.begin(); ap != mAntigens.end(); ++ap) {
-        if (full_name == (ap->first + " " + ap->second)) {
-            result = static_cast<size_t>(ap - mAntigens.begin());
-            break;
+    mAntigenIndex.make(mAntigens);
+    mSerumIndex.make(mSera);
+
+} // ChartData::make_index
+
+// ----------------------------------------------------------------------
+
+size_t FullNameIndex::hash(std::string_view aData, size_t aHash)
+{
+    for (char c: aData) {
+        aHash ^= static_cast<unsigned char>(c);
+        aHash *= 1099511628211ULL;
+    }
+    return aHash;
+
+} // FullNameIndex::hash
+
+// ----------------------------------------------------------------------
+
+void FullNameIndex::make(const std::vector<AgSrRef>& aRefs)
+{
+    mIndex.clear();
+    mIndex.reserve(aRefs.size());
+    for (size_t index = 0; index < aRefs.size(); ++index)
+        mIndex.emplace(hash(aRefs[index].second, hash(" ", hash(aRefs[index].first))), index);
+
+} // FullNameIndex::make
+
+// ----------------------------------------------------------------------
+
+size_t FullNameIndex::find(const std::vector<AgSrRef>& aRefs, std::string_view aFullName) const
+{
+    if (mIndex.size() == aRefs.size()) {
+        const auto [first, last] = mIndex.equal_range(hash(aFullName));
+        for (auto entry = first; entry != last; ++entry) {
+            if (match(aRefs[entry->second], aFullName))
+                return entry->second;
         }
     }
-    return result;
+    else {                      // index not made
+        for (auto ap = aRefs.begin(); ap != aRefs.end(); ++ap) {
+            if (match(*ap, aFullName))
+                return static_cast<size_t>(ap - aRefs.begin());
+        }
+    }
+    return static_cast<size_t>(-1); // not found
 
-} // ChartData::antigen_index_by_full_name
+} // FullNameIndex::find
 
 // ----------------------------------------------------------------------
 
@@ -95,45 +136,122 @@ AntigenRefs& AntigenRefs::date_range(std::string aBegin, std::string aEnd)
 
 // ----------------------------------------------------------------------
 
-void hidb::Antigens::make_index(const HiDb& aHiDb)
+void hidb::Antigens::make_index()
 {
-    std::smatch m;
-    for (const auto& antigen: *this) {
-        try {
-            const std::string key = index_key(antigen.data().name());
-            auto p = mIndex.find(key);
-            if (p == mIndex.end()) {
-                p = mIndex.emplace(key, AntigenRefs(aHiDb, size() / 16)).first;
-            }
-            p->second.push_back(&antigen);
-        }
-        catch (NotFound&) {
-        }
+    mIndex.clear();
+    mDateIndex.clear();
+    mDateIndex.reserve(size());
+    decltype(mFullNameIndex)::Entries full_names;
+    full_names.reserve(size());
+    for (size_t no = 0; no < size(); ++no) {
+        const auto& antigen = (*this)[no];
+        if (const auto key = index_key(antigen.data().name()); key)
+            mIndex[*key].push_back(no);
+        if (auto date = antigen.date(); !date.empty())
+            mDateIndex.emplace_back(std::move(date), no);
+        full_names.emplace_back(antigen.data().full_name(), no);
     }
     // std::cerr << "HiDb: " << size() << " antigens " << mIndex.size() << " index entries" << std::endl;
+    std::sort(mDateIndex.begin(), mDateIndex.end()); // by date, then by ordinal
+    mFullNameIndex.make(std::move(full_names));
 
 } // hidb::Antigens::make_index
 
 // ----------------------------------------------------------------------
 
-AntigenRefs hidb::Antigens::find_by_index(std::string name, std::string* aNotFoundLocation) const
+  // Names and full names of the existing antigens are not parsed/made again,
+  // their ordinals are just shifted, the result is the same as make_index().
+void hidb::Antigens::update_index(const std::vector<size_t>& aInserted, const std::vector<size_t>& aChanged)
 {
-    AntigenRefs result;
-    try {
-        std::string n_virus_type, n_host, n_location, n_isolation, n_year, n_passage, n_key;
-        split(name, n_virus_type, n_host, n_location, n_isolation, n_year, n_passage, n_key);
+    const OrdinalShift shift(aInserted);
+
+    std::map<std::string, std::vector<size_t>> inserted_by_key;
+    for (auto no: aInserted) {
+        if (const auto key = index_key((*this)[no].data().name()); key)
+            inserted_by_key[*key].push_back(no);
+    }
+    for (auto& [key, ordinals]: mIndex) {
+        for (auto& no: ordinals)
+            no = shift(no);
+    }
+    for (const auto& [key, inserted]: inserted_by_key) {
+        auto& ordinals = mIndex[key];
+        const auto old_size = static_cast<std::ptrdiff_t>(ordinals.size());
+        ordinals.insert(ordinals.end(), inserted.begin(), inserted.end());
+        std::inplace_merge(ordinals.begin(), ordinals.begin() + old_size, ordinals.end());
+    }
+
+      // date of an antigen is the most recent date of its tables, it may change for existing antigens
+    for (auto& entry: mDateIndex)
+        entry.second = shift(entry.second);
+    mDateIndex.erase(std::remove_if(mDateIndex.begin(), mDateIndex.end(), [&aChanged](const auto& entry) { return std::binary_search(aChanged.begin(), aChanged.end(), entry.second); }), mDateIndex.end());
+    const auto old_size = static_cast<std::ptrdiff_t>(mDateIndex.size());
+    for (auto no: aChanged) {
+        if (auto date = (*this)[no].date(); !date.empty())
+            mDateIndex.emplace_back(std::move(date), no);
+    }
+    std::sort(mDateIndex.begin() + old_size, mDateIndex.end());
+    std::inplace_merge(mDateIndex.begin(), mDateIndex.begin() + old_size, mDateIndex.end());
+
+    decltype(mFullNameIndex)::Entries full_names;
+    full_names.reserve(aInserted.size());
+    for (auto no: aInserted)
+        full_names.emplace_back((*this)[no].data().full_name(), no);
+    mFullNameIndex.insert(std::move(full_names), [&shift](size_t no) { return shift(no); });
+
+} // hidb::Antigens::update_index
+
+// ----------------------------------------------------------------------
+
+const AntigenRefs& hidb::Antigens::all_by_index(std::string name, QueryContext& aContext) const
+{
+    auto& result = aContext.mAntigens;
+    result.clear();
+    if (const auto key = index_key(name); key) {
+        if (const auto* fk = for_key(*key); fk) {
+            for (auto no: *fk)
+                result.push_back(&(*this)[no]);
+        }
+    }
+    return result;
+
+} // hidb::Antigens::all_by_index
+
+// ----------------------------------------------------------------------
+
+std::vector<const AntigenData*> hidb::Antigens::find_by_full_name_prefix(std::string prefix, size_t aLimit) const
+{
+    std::vector<const AntigenData*> result;
+    for (auto no: mFullNameIndex.find(prefix, aLimit))
+        result.push_back(&(*this)[no]);
+    return result;
+
+} // hidb::Antigens::find_by_full_name_prefix
+
+// ----------------------------------------------------------------------
+
+const AntigenRefs& hidb::Antigens::find_by_index(std::string name, QueryContext& aContext, std::string* aNotFoundLocation) const
+{
+    auto& result = aContext.mAntigens;
+    result.clear();
+    auto& fields = aContext.mName;
+    if (split(name, fields)) {
+        const auto& n_host = fields[1], n_location = fields[2], n_isolation = fields[3], n_year = fields[4];
         try {
             const auto location = get_locdb().find(n_location);
-            n_key = location.name.substr(0, IndexKeySize);
-            const AntigenRefs* fk = for_key(n_key);
+            if (!mNameFilter.may_contain(name_key(n_host, location.name, n_isolation, n_year)))
+                return result;  // not in hidb, avoid splitting names in the bucket
+            const auto* fk = for_key(location.name.substr(0, IndexKeySize));
             if (fk) {
-                result = *fk;
-                auto not_match_fields = [&](const auto& e) -> bool {
-                    std::string f_virus_type, f_host, f_location, f_isolation, f_year, f_passage, f_key;
-                    this->split(e->data().name(), f_virus_type, f_host, f_location, f_isolation, f_year, f_passage, f_key); // gcc 6.2 wants this->
-                    return f_host != n_host || f_location != location.name || f_isolation != n_isolation || f_year != n_year;
+                auto& entry = aContext.mEntry;
+                auto match_fields = [&](const auto& e) -> bool {
+                    return this->split(e->data().name(), entry) // gcc 6.2 wants this->
+                            && entry[1] == n_host && entry[2] == location.name && entry[3] == n_isolation && entry[4] == n_year;
                 };
-                result.erase(std::remove_if(result.begin(), result.end(), not_match_fields), result.end());
+                for (auto no: *fk) {
+                    if (const auto* antigen = &(*this)[no]; match_fields(antigen))
+                        result.push_back(antigen);
+                }
             }
         }
         catch (LocationNotFound&) {
@@ -144,10 +262,8 @@ AntigenRefs hidb::Antigens::find_by_index(std::string name, std::string* aNotFou
                 std::cerr << "LocationNotFound " << n_location << std::endl;
         }
     }
-    catch (NotFound&) {
-        if (name.size() > 3 && name[2] == ' ') { // CDC name?
-            find_by_index_cdc_name(name, result);
-        }
+    else if (is_cdc_name(name)) {
+        find_by_index_cdc_name(name, result);
     }
     return result;
 
@@ -155,33 +271,64 @@ AntigenRefs hidb::Antigens::find_by_index(std::string name, std::string* aNotFou
 
 // ----------------------------------------------------------------------
 
-void hidb::Antigens::find_by_index_cdc_name(std::string name, AntigenRefs& aResult) const
+void hidb::Antigens::make_name_filter(size_t aCapacity)
 {
-    const std::string key = index_key(name);
-    const AntigenRefs* fk = for_key(key);
-    if (fk) {
-        const auto found1 = std::find_if(fk->begin(), fk->end(), [&name](const auto& e) -> bool { return e->data().full_name() == name; });
-        if (found1 != fk->end()) {
-              // exact match
-            aResult.push_back(*found1);
-        }
-        else {
-              // try with prefix
-            std::string prefix(name, 0, name.find(' ', 3));
-            for (const auto& e: *fk) {
-                if (e->data().full_name().substr(0, prefix.size()) == prefix)
-                    aResult.push_back(e);
-            }
+    mNameFilter = BloomFilter(aCapacity);
+    for (auto antigen = begin(); antigen != end(); ++antigen) {
+        if (antigen == begin() || antigen->data().name() != std::prev(antigen)->data().name()) // antigens are sorted by name
+            add_to_name_filter(*antigen);
+    }
 
-            if (aResult.empty() && name[2] == ' ') {
-                  // use all names with matching cdc abbreviation as a suggestion
-                std::copy_if(fk->begin(), fk->end(), std::back_inserter(aResult), [&name](const auto& e) -> bool { return e->data().full_name().substr(0, 2) == name.substr(0, 2); });
-            }
+} // hidb::Antigens::make_name_filter
+
+// ----------------------------------------------------------------------
+
+void hidb::Antigens::add_to_name_filter(const AntigenData& aAntigen)
+{
+    std::string virus_type, host, location, isolation, year, passage, key;
+    if (split(aAntigen.data().name(), virus_type, host, location, isolation, year, passage, key))
+        mNameFilter.add(name_key(host, location, isolation, year));
+
+} // hidb::Antigens::add_to_name_filter
+
+// ----------------------------------------------------------------------
+
+bool hidb::Antigens::may_contain_name(std::string name) const
+{
+    std::string virus_type, host, location, isolation, year, passage, key;
+    if (!split(name, virus_type, host, location, isolation, year, passage, key))
+        return true;            // perhaps cdc name
+    try {
+        return mNameFilter.may_contain(name_key(host, get_locdb().find(location).name, isolation, year));
+    }
+    catch (LocationNotFound&) {
+        return false;
+    }
+
+} // hidb::Antigens::may_contain_name
+
+// ----------------------------------------------------------------------
+
+void hidb::Antigens::find_by_index_cdc_name(std::string name, AntigenRefs& aResult) const
+{
+      // names starting with prefix, exact match is among them
+    const std::string prefix(name, 0, name.find(' ', 3));
+    const AntigenData* exact = nullptr;
+    mFullNameIndex.for_each(prefix, [&](const std::string& full_name, size_t no) {
+        if (full_name == name) {
+            exact = &(*this)[no];
+            return false;
         }
+        aResult.push_back(&(*this)[no]);
+        return true;
+    });
+    if (exact) {
+        aResult.assign(1, exact);
     }
-    else {
-          //std::cerr << "find_by_index not recognized name: " << name << " index-key: " << key << " " << (fk ? fk->size() : 0) << std::endl;
-          // Not a recognized name, ignore it
+    else if (aResult.empty()) {
+          // use all names with matching cdc abbreviation as a suggestion, prefix includes space after it (e.g. "MD "),
+          // so that international names of a location starting with the same letters are not enumerated
+        mFullNameIndex.for_each(std::string_view(name).substr(0, 3), [this,&aResult](const std::string&, size_t no) { aResult.push_back(&(*this)[no]); return true; });
     }
 
 } // hidb::Antigens::find_by_index_cdc_name
@@ -193,9 +340,11 @@ AntigenRefs hidb::Antigens::find_by_cdcid(std::string cdcid) const
     if (std::isdigit(cdcid[0]))
         cdcid = "CDC#" + cdcid;
     AntigenRefs result;
-    for (const auto& antigen: *this) {
-        if (antigen.has_lab_id(cdcid))
-            result.push_back(&antigen);
+    if (const auto lab_id = InternedString::existing(cdcid); lab_id) { // otherwise no antigen has it
+        for (const auto& antigen: *this) {
+            if (antigen.has_lab_id(*lab_id))
+                result.push_back(&antigen);
+        }
     }
     return result;
 
@@ -203,6 +352,135 @@ AntigenRefs hidb::Antigens::find_by_cdcid(std::string cdcid) const
 
 // ----------------------------------------------------------------------
 
+AntigenRefs hidb::Antigens::date_range(const HiDb& aHiDb, std::string aBegin, std::string aEnd) const
+{
+    auto first = mDateIndex.begin(), last = mDateIndex.end();
+    if (!aBegin.empty())
+        first = std::lower_bound(first, last, aBegin, [](const auto& entry, const std::string& date) { return entry.first < date; });
+    if (!aEnd.empty())
+        last = std::lower_bound(first, last, aEnd, [](const auto& entry, const std::string& date) { return entry.first < date; });
+    AntigenRefs result(aHiDb, static_cast<size_t>(last - first));
+    std::transform(first, last, std::back_inserter(result), [this](const auto& entry) { return &(*this)[entry.second]; });
+    return result;
+
+} // hidb::Antigens::date_range
+
+// ----------------------------------------------------------------------
+
+hidb::LocationDateIndex::LocationDateIndex(const HiDb& aHiDb)
+    : mHiDb(aHiDb)
+{
+    const auto& records = mHiDb.antigen_stat_records();
+    for (const auto& antigen: mHiDb.antigens()) {
+        auto date = antigen.date();
+        if (date.empty())
+            continue;
+        mRegions[std::string{}].emplace_back(date, &antigen);
+        if (const auto record_no = records.find(antigen.data().name()); record_no != StatRecords::NotFound) {
+            if (const auto& country = records.value(record_no, StatRecords::Country); !country.empty())
+                mRegions[country].emplace_back(date, &antigen);
+            if (const auto& continent = records.value(record_no, StatRecords::Continent); !continent.empty())
+                mRegions[continent].emplace_back(date, &antigen);
+        }
+    }
+    for (auto& [region, entries]: mRegions)
+        std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+} // hidb::LocationDateIndex::LocationDateIndex
+
+// ----------------------------------------------------------------------
+
+std::pair<hidb::LocationDateIndex::Entries::const_iterator, hidb::LocationDateIndex::Entries::const_iterator> hidb::LocationDateIndex::find(std::string aRegion, std::string aBegin, std::string aEnd) const
+{
+    const auto found = mRegions.find(aRegion);
+    if (found == mRegions.end())
+        return {};
+    auto first = found->second.begin(), last = found->second.end();
+    if (!aBegin.empty())
+        first = std::lower_bound(first, last, aBegin, [](const auto& entry, const std::string& date) { return entry.first < date; });
+    if (!aEnd.empty())
+        last = std::lower_bound(first, last, aEnd, [](const auto& entry, const std::string& date) { return entry.first < date; });
+    return {first, last};
+
+} // hidb::LocationDateIndex::find
+
+// ----------------------------------------------------------------------
+
+AntigenRefs hidb::LocationDateIndex::antigens(std::string aRegion, std::string aBegin, std::string aEnd) const
+{
+    const auto [first, last] = find(aRegion, aBegin, aEnd);
+    AntigenRefs result(mHiDb, static_cast<size_t>(last - first));
+    std::transform(first, last, std::back_inserter(result), [](const auto& entry) { return entry.second; });
+    return result;
+
+} // hidb::LocationDateIndex::antigens
+
+// ----------------------------------------------------------------------
+
+size_t hidb::LocationDateIndex::count(std::string aRegion, std::string aBegin, std::string aEnd) const
+{
+    const auto [first, last] = find(aRegion, aBegin, aEnd);
+    return static_cast<size_t>(last - first);
+
+} // hidb::LocationDateIndex::count
+
+// ----------------------------------------------------------------------
+
+std::map<std::string, size_t> hidb::LocationDateIndex::count_by_month(std::string aRegion, std::string aBegin, std::string aEnd) const
+{
+    std::map<std::string, size_t> result;
+    auto [first, last] = find(aRegion, aBegin, aEnd);
+    while (first != last) {
+          // entries are sorted by date, skip to the first entry of the next month, dates without month (YYYY) are counted separately
+        const auto& date = first->first;
+        const bool has_month = date.size() >= 7;
+        const auto next = std::upper_bound(first, last, has_month ? date.substr(0, 7) + "-99" : date, [](const std::string& bound, const auto& entry) { return bound < entry.first; });
+        result.emplace(has_month ? date.substr(0, 4) + date.substr(5, 2) : date, static_cast<size_t>(next - first));
+        first = next;
+    }
+    return result;
+
+} // hidb::LocationDateIndex::count_by_month
+
+// ----------------------------------------------------------------------
+
+std::vector<std::string> hidb::LocationDateIndex::regions() const
+{
+    std::vector<std::string> result;
+    for (const auto& [region, entries]: mRegions) {
+        if (!region.empty())
+            result.push_back(region);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+
+} // hidb::LocationDateIndex::regions
+
+// ----------------------------------------------------------------------
+
+std::shared_ptr<const hidb::LocationDateIndex> HiDb::location_date_index() const
+{
+    auto index = std::atomic_load(&mLocationDateIndex);
+    if (!index) {
+        prepare_stat();
+        auto made = std::make_shared<const LocationDateIndex>(*this);
+        if (std::atomic_compare_exchange_strong(&mLocationDateIndex, &index, made)) // another thread may have made it meanwhile, then index is set to that one
+            index = made;
+    }
+    return index;
+
+} // HiDb::location_date_index
+
+// ----------------------------------------------------------------------
+
+AntigenRefs HiDb::antigens_by_location_date(std::string aRegion, std::string aBegin, std::string aEnd) const
+{
+    return location_date_index()->antigens(aRegion, aBegin, aEnd);
+
+} // HiDb::antigens_by_location_date
+
+// ----------------------------------------------------------------------
+
 AntigenRefs hidb::Antigens::all(const HiDb& aHiDb) const
 {
     AntigenRefs result(aHiDb, size());
@@ -213,30 +491,161 @@ AntigenRefs hidb::Antigens::all(const HiDb& aHiDb) const
 
 // ----------------------------------------------------------------------
 
-void HiDb::add(const Chart& aChart)
+void hidb::HomologousSera::make(const Sera& aSera)
+{
+    mIndex.clear();
+    for (size_t serum_no = 0; serum_no < aSera.size(); ++serum_no) {
+        for (const auto& homologous_variant_id: aSera[serum_no].homologous_variant_ids())
+            mIndex[{aSera[serum_no].data().name(), homologous_variant_id}].push_back(serum_no);
+    }
+
+} // hidb::HomologousSera::make
+
+// ----------------------------------------------------------------------
+
+void hidb::HomologousSera::insert(const OrdinalShift& aShift)
+{
+    if (aShift.number_of_inserted() == 0)
+        return;
+    for (auto& entry: mIndex) {
+        for (auto& serum_no: entry.second)
+            serum_no = aShift(serum_no);
+    }
+
+} // hidb::HomologousSera::insert
+
+// ----------------------------------------------------------------------
+
+void hidb::HomologousSera::add(size_t aSerumNo, const SerumData& aSerum, std::string aHomologousVariantId)
+{
+    auto& sera = mIndex[{aSerum.data().name(), aHomologousVariantId}];
+    const auto insert_at = std::lower_bound(sera.begin(), sera.end(), aSerumNo);
+    if (insert_at == sera.end() || *insert_at != aSerumNo)
+        sera.insert(insert_at, aSerumNo);
+
+} // hidb::HomologousSera::add
+
+// ----------------------------------------------------------------------
+
+void hidb::Tables::make_index()
+{
+    mSorted.resize(mStorage.size());
+    std::transform(mStorage.begin(), mStorage.end(), mSorted.begin(), [](auto& chart) { return chart.get(); });
+    std::sort(mSorted.begin(), mSorted.end(), [](const auto* a, const auto* b) { return *a < *b; });
+    mIndex.clear();
+    mIndex.reserve(mSorted.size());
+    for (auto* chart: mSorted)
+        mIndex.emplace(chart->table_id(), chart);
+
+} // hidb::Tables::make_index
+
+// ----------------------------------------------------------------------
+
+const ChartData& hidb::Tables::add(ChartData&& aChart)
+{
+    if (mIndex.find(aChart.table_id()) != mIndex.end())
+        throw std::runtime_error("Chart " + aChart.table_id() + " already in hidb");
+    auto* chart = mStorage.emplace_back(std::make_shared<ChartData>(std::move(aChart))).get();
+    mSorted.insert(std::upper_bound(mSorted.begin(), mSorted.end(), chart, [](const auto* a, const auto* b) { return *a < *b; }), chart);
+    mIndex.emplace(chart->table_id(), chart);
+    return *chart;
+
+} // hidb::Tables::add
+
+// ----------------------------------------------------------------------
+
+const std::vector<size_t>* hidb::HomologousSera::find(std::string aAntigenName, std::string aAntigenVariantId) const
+{
+    const auto found = mIndex.find({aAntigenName, aAntigenVariantId});
+    return found != mIndex.end() ? &found->second : nullptr;
+
+} // hidb::HomologousSera::find
+
+// ----------------------------------------------------------------------
+
+  // ordinal of the entry with the key (name, variant_id) in sorted aEntries
+template <typename Entries, typename Key> static size_t ordinal_of(const Entries& aEntries, const Key& aKey)
+{
+    const auto found = std::lower_bound(aEntries.begin(), aEntries.end(), aKey, [](const auto& a, const auto& b) { return a.data().name() == b.first ? variant_id(a.data()) < b.second : a.data().name() < b.first; });
+    return static_cast<size_t>(found - aEntries.begin());
+
+} // ordinal_of
+
+  // sorted ordinals of entries with the keys (name, variant_id) in sorted aEntries
+template <typename Entries, typename Key> static std::vector<size_t> ordinals_of(const Entries& aEntries, const std::vector<Key>& aKeys)
+{
+    std::vector<size_t> result(aKeys.size());
+    std::transform(aKeys.begin(), aKeys.end(), result.begin(), [&aEntries](const auto& aKey) { return ordinal_of(aEntries, aKey); });
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+
+} // ordinals_of
+
+// ----------------------------------------------------------------------
+
+void HiDb::add(const std::vector<const Chart*>& aCharts)
+{
+    if (mStatRecordsMade) {
+        mStatRecordsMade = false; // records of added names are updated by prepare_stat(), it needs locdb
+        mStatRecordsOutdated = true;
+    }
+
+    Added added;
+    for (const auto* chart: aCharts)
+        add_chart(*chart, added);
+    const auto antigen_ordinals = ordinals_of(mAntigens, added.antigens), serum_ordinals = ordinals_of(mSera, added.sera);
+    const auto changed_antigen_ordinals = ordinals_of(mAntigens, added.changed_antigens);
+
+      // indices refer to antigens and sera by ordinal, ordinals past inserted entries are shifted
+    mAntigens.update_index(antigen_ordinals, changed_antigen_ordinals);
+    mHomologousSera.insert(OrdinalShift(serum_ordinals));
+    for (const auto& [serum, homologous_variant_id]: added.homologous) {
+        const auto serum_no = ordinal_of(mSera, serum);
+        mHomologousSera.add(serum_no, mSera[serum_no], homologous_variant_id);
+    }
+    update_bitmaps(antigen_ordinals, changed_antigen_ordinals, serum_ordinals, ordinals_of(mSera, added.changed_sera));
+    update_filters(antigen_ordinals, serum_ordinals);
+    std::atomic_store(&mVaccineIndex, std::shared_ptr<const VaccineIndex>{});
+    std::atomic_store(&mLocationDateIndex, std::shared_ptr<const LocationDateIndex>{});
+
+} // HiDb::add
+
+// ----------------------------------------------------------------------
+
+void HiDb::add_chart(const Chart& aChart, Added& aAdded)
 {
     ChartData chart(aChart);
     std::cout << chart.table_id() << std::endl;
-    mCharts.insert(mCharts.insert_pos(chart), std::move(chart));
+    add_lab(chart.chart_info().lab());
+    mCharts.add(std::move(chart));
 
     aChart.find_homologous_antigen_for_sera_const();
 
     const std::string tbl_id = table_id(aChart);
     for (const auto& antigen: aChart.antigens()) {
-        add_antigen(antigen, tbl_id);
+        add_antigen(antigen, tbl_id, aAdded);
     }
     for (const auto& serum: aChart.sera()) {
-        add_serum(serum, tbl_id, aChart.antigens());
+        add_serum(serum, tbl_id, aChart.antigens(), aAdded);
+    }
+    for (const auto& antigen: aChart.antigens()) {
+        if (!antigen.distinct())
+            mStatAddedAntigens.insert(antigen.name());
+    }
+    for (const auto& serum: aChart.sera()) {
+        if (!serum.distinct())
+            mStatAddedSera.insert(serum.name());
     }
 
     // std::cout << "Chart: antigens:" << aChart.number_of_antigens() << " sera:" << aChart.number_of_sera() << std::endl;
     // std::cout << "HDb: antigens:" << mAntigens.size() << " sera:" << mSera.size() << std::endl;
 
-} // HiDb::add
+} // HiDb::add_chart
 
 // ----------------------------------------------------------------------
 
-void HiDb::add_antigen(const Antigen& aAntigen, std::string aTableId)
+void HiDb::add_antigen(const Antigen& aAntigen, std::string aTableId, Added& aAdded)
 {
     if (!aAntigen.distinct()) {
         AntigenData antigen_data(aAntigen);
@@ -248,15 +657,18 @@ void HiDb::add_antigen(const Antigen& aAntigen, std::string aTableId)
         }
         else {
             insert_at = mAntigens.insert(insert_at, std::move(antigen_data));
+            aAdded.antigens.emplace_back(insert_at->data().name(), variant_id(insert_at->data()));
         }
+        aAdded.changed_antigens.emplace_back(insert_at->data().name(), variant_id(insert_at->data()));
         insert_at->update(aTableId, aAntigen);
+        insert_at->update_summary(*this);
     }
 
 } // HiDb::add_antigen
 
 // ----------------------------------------------------------------------
 
-void HiDb::add_serum(const Serum& aSerum, std::string aTableId, const std::vector<Antigen>& aAntigens)
+void HiDb::add_serum(const Serum& aSerum, std::string aTableId, const std::vector<Antigen>& aAntigens, Added& aAdded)
 {
     if (!aSerum.distinct()) {
         SerumData serum_data(aSerum);
@@ -267,18 +679,112 @@ void HiDb::add_serum(const Serum& aSerum, std::string aTableId, const std::vecto
         }
         else {
             insert_at = mSera.insert(insert_at, std::move(serum_data));
+            aAdded.sera.emplace_back(insert_at->data().name(), variant_id(insert_at->data()));
         }
+        aAdded.changed_sera.emplace_back(insert_at->data().name(), variant_id(insert_at->data()));
         insert_at->update(aTableId, aSerum);
-        if (aSerum.has_homologous())
-            insert_at->set_homologous(aTableId, variant_id(aAntigens[aSerum.homologous()[0]]));
+        insert_at->update_summary(*this);
+        if (aSerum.has_homologous()) {
+            const std::string homologous_variant_id = variant_id(aAntigens[aSerum.homologous()[0]]);
+            insert_at->set_homologous(aTableId, homologous_variant_id);
+            aAdded.homologous.emplace_back(Added::Key{insert_at->data().name(), variant_id(insert_at->data())}, homologous_variant_id);
+        }
     }
 
 } // HiDb::add_serum
 
 // ----------------------------------------------------------------------
 
+void HiDb::add_lab(std::string aLab)
+{
+    if (std::find(mLabs.begin(), mLabs.end(), aLab) == mLabs.end())
+        mLabs.push_back(aLab);  // labs beyond LabMaskBits are not in lab masks
+
+} // HiDb::add_lab
+
+// ----------------------------------------------------------------------
+
+void HiDb::update_summaries()
+{
+    for (const auto& chart: mCharts)
+        add_lab(chart.chart_info().lab());
+    for (auto& antigen: mAntigens)
+        antigen.update_summary(*this);
+    for (auto& serum: mSera)
+        serum.update_summary(*this);
+
+} // HiDb::update_summaries
+
+// ----------------------------------------------------------------------
+
+void HiDb::make_bitmaps()
+{
+    mAntigenBitmaps.make(*this, mAntigens);
+    mSerumBitmaps.make(*this, mSera);
+
+} // HiDb::make_bitmaps
+
+// ----------------------------------------------------------------------
+
+void HiDb::update_bitmaps(const std::vector<size_t>& aInsertedAntigens, const std::vector<size_t>& aChangedAntigens, const std::vector<size_t>& aInsertedSera, const std::vector<size_t>& aChangedSera)
+{
+    if (mAntigenBitmaps.size() + aInsertedAntigens.size() != mAntigens.size() || mSerumBitmaps.size() + aInsertedSera.size() != mSera.size()) {
+        make_bitmaps();         // bitmaps were not made
+        return;
+    }
+    mAntigenBitmaps.insert(OrdinalShift(aInsertedAntigens));
+    for (auto no: aChangedAntigens)
+        mAntigenBitmaps.update(*this, mAntigens[no], no);
+    mSerumBitmaps.insert(OrdinalShift(aInsertedSera));
+    for (auto no: aChangedSera)
+        mSerumBitmaps.update(*this, mSera[no], no);
+
+} // HiDb::update_bitmaps
+
+// ----------------------------------------------------------------------
+
+void HiDb::make_filters()
+{
+      // room for entries inserted by subsequent add(), filters are made again when it is used up
+    const auto with_room = [](size_t aSize) { return aSize + aSize / 4 + 1024; };
+    mAntigens.make_name_filter(with_room(mAntigens.size()));
+    mAntigenFilter = BloomFilter(with_room(mAntigens.size()));
+    for (const auto& antigen: mAntigens)
+        mAntigenFilter.add(name_for_exact_matching(antigen.data()));
+    mSerumFilter = BloomFilter(with_room(mSera.size()));
+    for (const auto& serum: mSera)
+        mSerumFilter.add(name_for_exact_matching(serum.data()));
+
+} // HiDb::make_filters
+
+// ----------------------------------------------------------------------
+
+void HiDb::update_filters(const std::vector<size_t>& aAntigenOrdinals, const std::vector<size_t>& aSerumOrdinals)
+{
+    if (mAntigens.size() > mAntigenFilter.capacity() || mAntigens.size() > mAntigens.name_filter_capacity() || mSera.size() > mSerumFilter.capacity()) {
+        make_filters();
+    }
+    else {
+        for (auto ordinal: aAntigenOrdinals) {
+            mAntigenFilter.add(name_for_exact_matching(mAntigens[ordinal].data()));
+            mAntigens.add_to_name_filter(mAntigens[ordinal]);
+        }
+        for (auto ordinal: aSerumOrdinals)
+            mSerumFilter.add(name_for_exact_matching(mSera[ordinal].data()));
+    }
+
+} // HiDb::update_filters
+
+// ----------------------------------------------------------------------
+
 void HiDb::exportTo(std::string aFilename, bool aPretty, report_time timer) const
 {
+    try {
+        prepare_stat();         // stat of names added by add() is not updated yet
+    }
+    catch (std::exception& err) {
+        std::cerr << "WARNING: hidb stat not exported, it will be made when hidb is used with locdb: " << err.what() << '\n';
+    }
     Timeit timeit("hidb exporting: ", timer);
     hidb_export(aFilename, *this, aPretty ? 1 : 0);
 
@@ -286,22 +792,213 @@ void HiDb::exportTo(std::string aFilename, bool aPretty, report_time timer) cons
 
 // ----------------------------------------------------------------------
 
-void HiDb::importFrom(std::string aFilename, report_time timer)
-{
-    Timeit timeit_load("DEBUG: HiDb loading from " + aFilename + ": ", timer);
-    hidb_import(aFilename, *this);
-    timeit_load.report();
-    if (std::string_view(aFilename).substr(aFilename.size() - 15) == "hidb4.b.json.xz")
-        mAntigens.location_func(&virus_name::location_human_b);
-    else if (std::string_view(aFilename).substr(aFilename.size() - 16) == "hidb4.h3.json.xz" || std::string_view(aFilename).substr(aFilename.size() - 16) == "hidb4.h1.json.xz")
-        mAntigens.location_func(&virus_name::location_human_a);
-    Timeit timeit_index("DEBUG: HiDb indexing: ", timer);
-    mAntigens.make_index(*this);
-    timeit_index.report();
-    if (timer == report_time::Yes)
-        std::cerr << "DEBUG: HiDb: " << mAntigens.size() << " antigens\n";
+void HiDb::importFrom(std::string aFilename, report_time timer)
+{
+    Timeit timeit_load("DEBUG: HiDb loading from " + aFilename + ": ", timer);
+    hidb_import(aFilename, *this);
+    timeit_load.report();
+    if (std::string_view(aFilename).substr(aFilename.size() - 15) == "hidb4.b.json.xz")
+        mAntigens.location_func(&virus_name::location_human_b);
+    else if (std::string_view(aFilename).substr(aFilename.size() - 16) == "hidb4.h3.json.xz" || std::string_view(aFilename).substr(aFilename.size() - 16) == "hidb4.h1.json.xz")
+        mAntigens.location_func(&virus_name::location_human_a);
+    Timeit timeit_index("DEBUG: HiDb indexing: ", timer);
+    mCharts.make_index();
+    for (auto& chart: mCharts)
+        chart.make_index();
+    update_summaries();
+    mAntigens.make_index();
+    mHomologousSera.make(mSera);
+    make_bitmaps();
+    make_filters();
+    mStatRecordsMade = !mAntigenStat.empty() || !mSerumStat.empty();
+    if (mStatRecordsMade) {
+        set_serum_stat_weights();
+        if (mAntigenCube.empty()) // hidb file made before stat cube was introduced
+            mAntigenCube.make(mAntigenStat);
+        mSerumCube.make(mSerumStat);
+        mSerumNameCube.make(mSerumStat, false);
+    }
+    timeit_index.report();
+    if (timer == report_time::Yes)
+        std::cerr << "DEBUG: HiDb: " << mAntigens.size() << " antigens\n";
+
+} // HiDb::importFrom
+
+// ----------------------------------------------------------------------
+
+std::shared_ptr<HiDb> HiDb::next_version() const
+{
+    auto result = std::make_shared<HiDb>();
+    result->mAntigens = mAntigens;
+    result->mSera = mSera;
+    result->mCharts = mCharts;
+    result->mLabs = mLabs;
+    result->mAntigenBitmaps = mAntigenBitmaps;
+    result->mSerumBitmaps = mSerumBitmaps;
+    {
+        std::unique_lock<std::mutex> lock{mStatMutex}; // readers of this version may be making stat records
+        result->mAntigenStat = mAntigenStat;
+        result->mSerumStat = mSerumStat;
+        result->mAntigenCube = mAntigenCube;
+        result->mSerumCube = mSerumCube;
+        result->mSerumNameCube = mSerumNameCube;
+        result->mStatRecordsMade = mStatRecordsMade.load();
+        result->mStatRecordsOutdated = mStatRecordsOutdated;
+        result->mStatAddedAntigens = mStatAddedAntigens;
+        result->mStatAddedSera = mStatAddedSera;
+    }
+    result->mHomologousSera = mHomologousSera;
+    result->mAntigenFilter = mAntigenFilter;
+    result->mSerumFilter = mSerumFilter;
+    return result;
+
+} // HiDb::next_version
+
+// ----------------------------------------------------------------------
+
+hidb::VersionedHiDb::VersionedHiDb(std::shared_ptr<HiDb> aHiDb)
+{
+    mCurrent = std::move(aHiDb);
+
+} // hidb::VersionedHiDb::VersionedHiDb
+
+// ----------------------------------------------------------------------
+
+void hidb::VersionedHiDb::add(const std::vector<const Chart*>& aCharts)
+{
+    std::unique_lock<std::mutex> lock{mWriterMutex};
+    auto next = snapshot()->next_version();
+    next->add(aCharts);         // indices of next are valid before it is published
+    std::atomic_store(&mCurrent, Snapshot{std::move(next)});
+    ++mVersion;
+
+} // hidb::VersionedHiDb::add
+
+// ----------------------------------------------------------------------
+
+  // FNV-1a over fields, each field is terminated, so that ("ab", "c") and ("a", "bc") differ
+class ContentHash
+{
+ public:
+    inline ContentHash& operator<<(std::string_view aField) { for (auto c: aField) add(static_cast<unsigned char>(c)); add(0xFF); return *this; }
+    inline ContentHash& operator<<(uint64_t aValue) { for (size_t byte = 0; byte < sizeof(aValue); ++byte) add(static_cast<unsigned char>(aValue >> (byte * 8))); return *this; }
+    inline uint64_t value() const { return mHash; }
+
+ private:
+    uint64_t mHash = 14695981039346656037ULL;
+    inline void add(unsigned char aByte) { mHash = (mHash ^ aByte) * 1099511628211ULL; }
+};
+
+using ContentHashes = std::unordered_map<std::string, uint64_t>; // key -> content hash
+
+static inline void hash_per_table(ContentHash& aHash, const std::vector<PerTable>& aPerTable)
+{
+    aHash << aPerTable.size();
+    for (const auto& pt: aPerTable) {
+        aHash << pt.table_id() << pt.date() << pt.homologous() << pt.lab_id().size();
+        for (const auto& lab_id: pt.lab_id())
+            aHash << lab_id;
+    }
+}
+
+static inline uint64_t content_hash(const AntigenData& aAntigen)
+{
+    ContentHash hash;
+    hash << aAntigen.data().lineage() << aAntigen.data().date();
+    hash_per_table(hash, aAntigen.per_table());
+    return hash.value();
+}
+
+static inline uint64_t content_hash(const SerumData& aSerum)
+{
+    ContentHash hash;
+    hash << aSerum.data().lineage() << aSerum.data().serum_species();
+    hash_per_table(hash, aSerum.per_table());
+    return hash.value();
+}
+
+static inline uint64_t content_hash(const ChartData& aChart)
+{
+    ContentHash hash;
+    const auto& info = aChart.chart_info();
+    hash << info.virus() << info.virus_type() << info.assay() << info.date() << info.lab() << info.rbc() << info.name() << info.subset();
+    hash << aChart.antigens().size();
+    for (const auto& antigen: aChart.antigens())
+        hash << antigen.first << antigen.second;
+    hash << aChart.sera().size();
+    for (const auto& serum: aChart.sera())
+        hash << serum.first << serum.second;
+    const auto& titers = aChart.titers();
+    for (size_t ag_no = 0; ag_no < titers.number_of_antigens(); ++ag_no) {
+        const auto* row = titers.row(ag_no);
+        for (size_t sr_no = 0; sr_no < titers.number_of_sera(); ++sr_no) {
+            if (TiterMatrix::qualifier(row[sr_no]) == TiterMatrix::Special && !TiterMatrix::dont_care(row[sr_no]))
+                hash << titers.titer(ag_no, sr_no); // code of a special titer is an index in the per table list
+            else
+                hash << uint64_t{row[sr_no]};
+        }
+    }
+    return hash.value();
+}
+
+  // entries with the same key (should not happen) are combined, their order does not matter
+template <typename Entries> static inline ContentHashes content_hashes(const Entries& aEntries)
+{
+    ContentHashes result;
+    for (const auto& entry: aEntries)
+        result[name_for_exact_matching(entry.data())] += content_hash(entry);
+    return result;
+}
+
+static inline HiDbDiff::Changes diff_of(const ContentHashes& aOlder, const ContentHashes& aNewer)
+{
+    HiDbDiff::Changes result;
+    for (const auto& [key, hash]: aNewer) {
+        if (const auto older = aOlder.find(key); older == aOlder.end())
+            result.added.push_back(key);
+        else if (older->second != hash)
+            result.changed.push_back(key);
+    }
+    for (const auto& entry: aOlder) {
+        if (aNewer.find(entry.first) == aNewer.end())
+            result.removed.push_back(entry.first);
+    }
+    std::sort(result.added.begin(), result.added.end());
+    std::sort(result.removed.begin(), result.removed.end());
+    std::sort(result.changed.begin(), result.changed.end());
+    return result;
+}
+
+HiDbDiff HiDb::diff(const HiDb& aNewer) const
+{
+    HiDbDiff result;
+    auto antigens = std::async(std::launch::async, [this, &aNewer]() { return diff_of(content_hashes(mAntigens), content_hashes(aNewer.mAntigens)); });
+    auto sera = std::async(std::launch::async, [this, &aNewer]() { return diff_of(content_hashes(mSera), content_hashes(aNewer.mSera)); });
+
+      // tables are compared in this thread, both lists are sorted by table_id
+    auto older = mCharts.begin(), newer = aNewer.mCharts.begin();
+    while (older != mCharts.end() || newer != aNewer.mCharts.end()) {
+        if (newer == aNewer.mCharts.end() || (older != mCharts.end() && older->table_id() < newer->table_id())) {
+            result.tables.removed.push_back(older->table_id());
+            ++older;
+        }
+        else if (older == mCharts.end() || newer->table_id() < older->table_id()) {
+            result.tables.added.push_back(newer->table_id());
+            ++newer;
+        }
+        else {
+            if (&*older != &*newer && content_hash(*older) != content_hash(*newer))
+                result.tables.changed.push_back(newer->table_id());
+            ++older;
+            ++newer;
+        }
+    }
+
+    result.antigens = antigens.get();
+    result.sera = sera.get();
+    return result;
 
-} // HiDb::importFrom
+} // HiDb::diff
 
 // ----------------------------------------------------------------------
 
@@ -411,6 +1108,7 @@ using FindSerumScore = AntigenSerumMatchScore<SerumData>;
 
 template <typename AntigenT, typename Data> inline static void find_scores(std::string name, const std::vector<AntigenT>& antigens, std::vector<AntigenSerumMatchScore<Data>>& scores, typename std::vector<AntigenSerumMatchScore<Data>>::iterator& scores_end)
 {
+    scores.clear();             // may be reused scratch of QueryContext
     string_match::score_t score_threshold = 0;
     for (const AntigenT& antigen: antigens) {
         scores.emplace_back(name, antigen, score_threshold);
@@ -439,43 +1137,43 @@ template <typename AntigenT, typename Data> inline static void find_scores(std::
 
 // ----------------------------------------------------------------------
 
-std::vector<const AntigenData*> HiDb::find_antigens(std::string name_reassortant_annotations_passage) const
+const std::vector<const AntigenData*>& HiDb::find_antigens(std::string name_reassortant_annotations_passage, QueryContext& aContext) const
 {
       // std::cerr << "find_antigens " << name_reassortant_annotations_passage << '\n';
-    AntigenRefs by_name = mAntigens.find_by_index(name_reassortant_annotations_passage);
-    std::vector<FindAntigenScore> scores;
+    const auto& by_name = mAntigens.find_by_index(name_reassortant_annotations_passage, aContext);
     std::vector<FindAntigenScore>::iterator scores_end;
-    find_scores(name_reassortant_annotations_passage, by_name, scores, scores_end);
-    return {scores.begin(), scores_end};
+    find_scores(name_reassortant_annotations_passage, by_name, aContext.mScores, scores_end);
+    aContext.mResult.assign(aContext.mScores.begin(), scores_end);
+    return aContext.mResult;
 
 } // HiDb::find_antigens
 
 // ----------------------------------------------------------------------
 
-const AntigenData& HiDb::find_antigen_exactly(std::string name_reassortant_annotations_passage) const
+const AntigenData* HiDb::lookup_antigen_exactly(std::string name_reassortant_annotations_passage, QueryContext& aContext) const
 {
-    AntigenRefs by_name = mAntigens.find_by_index(name_reassortant_annotations_passage);
-    auto found = std::find_if(by_name.begin(), by_name.end(), [&](const auto* a) -> bool { return name_reassortant_annotations_passage == name_for_exact_matching(a->data()); });
-    if (found == by_name.end())
-        throw NotFound(name_reassortant_annotations_passage, by_name);
-    return **found;
+    if (!mAntigenFilter.may_contain(name_reassortant_annotations_passage)) {
+        aContext.mAntigens.clear(); // definitely not in hidb, no suggestions
+        return nullptr;
+    }
+    const auto& by_name = mAntigens.find_by_index(name_reassortant_annotations_passage, aContext);
+    if (auto found = std::find_if(by_name.begin(), by_name.end(), [&](const auto* a) -> bool { return name_reassortant_annotations_passage == name_for_exact_matching(a->data()); }); found != by_name.end())
+        return *found;
+    return nullptr;
 
-} // HiDb::find_antigen_exactly
+} // HiDb::lookup_antigen_exactly
 
 // ----------------------------------------------------------------------
 
-std::vector<const AntigenData*> HiDb::find_antigens_fuzzy(std::string name_reassortant_annotations_passage) const
+const std::vector<const AntigenData*>& HiDb::find_antigens_fuzzy(std::string name_reassortant_annotations_passage, QueryContext& aContext) const
 {
-    const AntigenRefs* by_index = mAntigens.all_by_index(name_reassortant_annotations_passage);
-    if (by_index) {
-        std::vector<FindAntigenScore> scores;
+    aContext.mResult.clear();
+    if (const auto& by_index = mAntigens.all_by_index(name_reassortant_annotations_passage, aContext); !by_index.empty()) {
         std::vector<FindAntigenScore>::iterator scores_end;
-        find_scores(name_reassortant_annotations_passage, *by_index, scores, scores_end);
-        return {scores.begin(), scores_end};
-    }
-    else {
-        return {};
+        find_scores(name_reassortant_annotations_passage, by_index, aContext.mScores, scores_end);
+        aContext.mResult.assign(aContext.mScores.begin(), scores_end);
     }
+    return aContext.mResult;
 
 } // HiDb::find_antigens_fuzzy
 
@@ -505,22 +1203,42 @@ std::vector<std::pair<const AntigenData*, size_t>> HiDb::find_antigens_with_scor
 
 // ----------------------------------------------------------------------
 
-std::vector<const AntigenData*> HiDb::list_antigens(std::string aLab, std::string aLineage, std::string aAssay) const
+template <typename AS> static inline std::vector<const AS*> select_by_bitmap(const std::vector<AS>& aData, const Bitmap& aSelected)
 {
-    std::function<bool(const AntigenData&)> assay_check;
-    if (aAssay.empty())
-        assay_check = [](const AntigenData&) { return true; };
-    else if (string::upper(aAssay) == "HI")
-        assay_check = [this](const AntigenData& antigen) { return antigen.in_hi_assay(*this); };
-    else
-        assay_check = [this](const AntigenData& antigen) { return antigen.in_neut_assay(*this); };
-
-    std::vector<const AntigenData*> result;
-    for (const auto& antigen: antigens()) {
-        if ((aLab.empty() || antigen.has_lab(*this, aLab)) && (aLineage.empty() || antigen.lineage() == aLineage) && assay_check(antigen))
-            result.push_back(&antigen);
-    }
+    std::vector<const AS*> result;
+    result.reserve(aSelected.count());
+    aSelected.for_each([&](size_t no) { result.push_back(&aData[no]); });
     return result;
+}
+
+// ----------------------------------------------------------------------
+
+std::vector<const AntigenData*> HiDb::antigens_of(const Bitmap& aSelected) const
+{
+    return select_by_bitmap(mAntigens, aSelected);
+
+} // HiDb::antigens_of
+
+// ----------------------------------------------------------------------
+
+std::vector<const SerumData*> HiDb::sera_of(const Bitmap& aSelected) const
+{
+    return select_by_bitmap(mSera, aSelected);
+
+} // HiDb::sera_of
+
+// ----------------------------------------------------------------------
+
+std::vector<const AntigenData*> HiDb::list_antigens(std::string aLab, std::string aLineage, std::string aAssay) const
+{
+    Bitmap selected = mAntigenBitmaps.all();
+    if (!aLab.empty())
+        selected &= mAntigenBitmaps.get(BitmapIndex::Lab, aLab);
+    if (!aLineage.empty())
+        selected &= mAntigenBitmaps.get(BitmapIndex::Lineage, aLineage);
+    if (!aAssay.empty())
+        selected &= mAntigenBitmaps.get(BitmapIndex::Assay, string::upper(aAssay) == "HI" ? "HI" : "NEUT");
+    return antigens_of(selected);
 
 } // HiDb::list_antigens
 
@@ -532,11 +1250,8 @@ std::vector<std::string> HiDb::list_antigen_names(std::string aLab, std::string
         return aFullName ? ag.data().full_name() : ag.data().name();
     };
     std::vector<std::string> result;
-    for (const auto& serum: sera()) {
-        if ((aLab.empty() || serum.has_lab(*this, aLab)) && (aLineage.empty() || serum.lineage() == aLineage)) {
-            result.push_back(extract_name(serum));
-        }
-    }
+    for (const auto* serum: list_sera(aLab, aLineage))
+        result.push_back(extract_name(*serum));
     // if (!aLab.empty()) {
     //     for (const auto& antigen: antigens()) {
     //         if (antigen.has_lab(*this, aLab)) {
@@ -554,69 +1269,51 @@ std::vector<std::string> HiDb::list_antigen_names(std::string aLab, std::string
 
 // ----------------------------------------------------------------------
 
-// throws if not found
-const AntigenData& HiDb::find_antigen_of_chart(const Antigen& aAntigen) const
+AntigenLookup HiDb::lookup_antigen_of_chart(const Antigen& aAntigen) const
 {
     const std::string name = aAntigen.full_name();
-    try {
-        const auto& found = find_antigen_exactly(name);
-          // std::cerr << "find_in_hidb: " << full_name() << " --> " << found.most_recent_table().table_id() << " tables:" << found.number_of_tables() << std::endl;
-        return found;
-    }
-    catch (NotFound& err) {
+    auto result = lookup_antigen_exactly(name);
+    if (!result) {
         if (aAntigen.passage() == "X?") {
-            try {
-                return find_antigen_exactly(aAntigen.full_name_without_passage());
-            }
-            catch (NotFound&) {
-            }
+            if (const auto without_passage = lookup_antigen_exactly(aAntigen.full_name_without_passage()); without_passage)
+                result.found = without_passage.found; // suggestions of the original name are kept
         }
-        else if (!err.suggestions().empty()) {
-            return find_antigen_in_suggestions(name, err.suggestions());
+        else if (const auto fixed = fixed_name_of_chart(name); !fixed.empty()) {
+            if (const auto with_fixed_name = lookup_antigen_exactly(fixed); with_fixed_name)
+                result.found = with_fixed_name.found; // suggestions of the original name are kept
         }
-        else {
-            // std::cerr << "ERROR: not found and no suggestions for " << name << std::endl
-            //           << hidb::report(aHiDb.find_antigens(name), "  ") << std::endl;
+        else if (name.find(" DISTINCT") != std::string::npos) { // DISTINCT antigens are not stored in hidb
+            result.suggestions.clear();
         }
-        throw;
     }
+      // else std::cerr << "find_in_hidb: " << name << " --> " << result.found->most_recent_table().table_id() << " tables:" << result.found->number_of_tables() << std::endl;
+    return result;
 
-} // HiDb::find_antigen_of_chart
+} // HiDb::lookup_antigen_of_chart
 
 // ----------------------------------------------------------------------
 
-const AntigenData& HiDb::find_antigen_in_suggestions(std::string aName, const AntigenRefs& aSuggestions) const
+  // Names wrongly stored in old charts, fixed name is looked up exactly (i.e.
+  // probing the bloom filter first) instead of scanning suggestions of the name.
+std::string HiDb::fixed_name_of_chart(std::string aName)
 {
-    const std::regex wrongly_converted{" (SECM|VIR)(-)"};
+    static const std::regex wrongly_converted{" (SECM|VIR)(-)"}; // compiled once, regex_search does not modify it
     std::smatch m;
-
-    if (aName.find(" DISTINCT") != std::string::npos) { // DISTINCT antigens are not stored in hidb
-        throw NotFound(aName);
+    if (aName.find(" DISTINCT") != std::string::npos) {
+        return {};
     }
     else if (std::regex_search(aName, m, wrongly_converted)) {
-        // std::cerr << "SECM Suggestions for " << aName << std::endl
-        //           << hidb::report(aSuggestions, "  ") << std::endl;
         std::string name = aName;   // to avoid aName changing
         name[static_cast<size_t>(m[2].first - aName.begin())] = '0';
-        for (const auto& e: aSuggestions) {
-            if (e->data().full_name() == name)
-                return *e;
-        }
+        return name;
     }
-    else if (aName[2] == ' ') {
+    else if (aName.size() > 3 && aName[2] == ' ') {
           // some cdc names were incorrectly used before, e.g. "CO CO-9-2718" was used as "CO 9-2718"
-        std::string fixed = aName.substr(0, 3) + aName.substr(0, 2) + "-" + aName.substr(3);
-        // std::cerr << "FIXED: " << fixed << std::endl; // << report(*fk, "  ") << std::endl;
-        const auto found = std::find_if(aSuggestions.begin(), aSuggestions.end(), [&fixed](const auto& e) -> bool { return e->data().full_name() == fixed; });
-        if (found != aSuggestions.end())
-            return **found;
+        return aName.substr(0, 3) + aName.substr(0, 2) + "-" + aName.substr(3);
     }
+    return {};
 
-    // std::cerr << "Suggestions for " << aName << std::endl
-    //           << hidb::report(aSuggestions, "  "); // << std::endl;
-    throw NotFound(aName, aSuggestions);
-
-} // HiDb::find_antigen_in_suggestions
+} // HiDb::fixed_name_of_chart
 
 // ----------------------------------------------------------------------
 
@@ -631,17 +1328,27 @@ std::vector<const SerumData*> HiDb::find_sera(std::string name) const
 
 // ----------------------------------------------------------------------
 
-const SerumData& HiDb::find_serum_exactly(std::string name_reassortant_annotations_serum_id) const
+  // Sera are sorted by name, the name is the exact name or its part before a
+  // space (variant id follows it), each such prefix is looked up by
+  // lower_bound and only sera with that name are compared.
+const SerumData* HiDb::lookup_serum_exactly(std::string name_reassortant_annotations_serum_id) const
 {
-    const auto found = std::find_if(mSera.begin(), mSera.end(), [&](const auto& sr) -> bool { return name_reassortant_annotations_serum_id == name_for_exact_matching(sr.data()); });
-    if (found == mSera.end()) {
-        // std::cerr << "find_serum_exactly \"" << name_reassortant_annotations_serum_id << '"' << std::endl;
-        // for (const auto& sr: mSera) std::cerr << "  \"" << sr.data().name_for_exact_matching() << '"' << std::endl;
-        throw NotFound(name_reassortant_annotations_serum_id);
+    if (!mSerumFilter.may_contain(name_reassortant_annotations_serum_id))
+        return nullptr;
+    const auto& key = name_reassortant_annotations_serum_id;
+    for (size_t name_end = key.find(' '); ; name_end = key.find(' ', name_end + 1)) {
+        const auto name = key.substr(0, name_end);
+        for (auto serum = std::lower_bound(mSera.begin(), mSera.end(), name, [](const auto& a, const std::string& b) { return a.data().name() < b; });
+             serum != mSera.end() && serum->data().name() == name; ++serum) {
+            if (key == name_for_exact_matching(serum->data()))
+                return &*serum;
+        }
+        if (name_end == std::string::npos)
+            break;
     }
-    return *found;
+    return nullptr;
 
-} // HiDb::find_serum_exactly
+} // HiDb::lookup_serum_exactly
 
 // ----------------------------------------------------------------------
 
@@ -660,12 +1367,12 @@ std::vector<std::pair<const SerumData*, size_t>> HiDb::find_sera_with_score(std:
 
 std::vector<const SerumData*> HiDb::list_sera(std::string aLab, std::string aLineage) const
 {
-    std::vector<const SerumData*> result;
-    for (const auto& serum: sera()) {
-        if ((aLab.empty() || serum.has_lab(*this, aLab)) && (aLineage.empty() || serum.lineage() == aLineage))
-            result.push_back(&serum);
-    }
-    return result;
+    Bitmap selected = mSerumBitmaps.all();
+    if (!aLab.empty())
+        selected &= mSerumBitmaps.get(BitmapIndex::Lab, aLab);
+    if (!aLineage.empty())
+        selected &= mSerumBitmaps.get(BitmapIndex::Lineage, aLineage);
+    return sera_of(selected);
 
 } // HiDb::list_sera
 
@@ -677,11 +1384,8 @@ std::vector<std::string> HiDb::list_serum_names(std::string aLab, std::string aL
         return aFullName ? sr.data().full_name() : sr.data().name();
     };
     std::vector<std::string> result;
-    for (const auto& serum: sera()) {
-        if ((aLab.empty() || serum.has_lab(*this, aLab)) && (aLineage.empty() || serum.lineage() == aLineage)) {
-            result.push_back(extract_name(serum));
-        }
-    }
+    for (const auto* serum: list_sera(aLab, aLineage))
+        result.push_back(extract_name(*serum));
 
     // if (!aLab.empty()) {
     //     for (const auto& serum: sera()) {
@@ -703,13 +1407,8 @@ std::vector<std::string> HiDb::list_serum_names(std::string aLab, std::string aL
 std::vector<const SerumData*> HiDb::find_homologous_sera(const AntigenData& aAntigen) const
 {
     std::vector<const SerumData*> result;
-    const std::string antigen_name = aAntigen.data().name();
-    const std::string antigen_variant_id = variant_id(aAntigen.data());
-    for (const auto& serum: sera()) {
-        if (serum.data().name() == antigen_name && serum.has_homologous_variant_id(antigen_variant_id)) {
-            result.push_back(&serum);
-        }
-    }
+    if (const auto* found = mHomologousSera.find(aAntigen.data().name(), variant_id(aAntigen.data())); found)
+        std::transform(found->begin(), found->end(), std::back_inserter(result), [this](size_t aSerumNo) { return &mSera[aSerumNo]; });
     return result;
 
 } // HiDb::find_homologous_sera
@@ -719,29 +1418,126 @@ std::vector<const SerumData*> HiDb::find_homologous_sera(const AntigenData& aAnt
 // throws if not found
 const SerumData& HiDb::find_serum_of_chart(const Serum& aSerum, bool report_if_not_found) const
 {
-    try {
-        const auto& found = find_serum_exactly(aSerum.full_name());
-          // std::cerr << "find_in_hidb: " << aSerum.full_name() << " --> " << found.most_recent_table().table_id() << " tables:" << found.number_of_tables() << std::endl;
-        return found;
-    }
-    catch (NotFound& err) {
-        if (report_if_not_found) {
-            std::cerr << "ERROR: serum not found in hidb " << err.what() << std::endl;
-            std::cerr << report(find_sera(aSerum.full_name()), "  ") << std::endl;
-        }
-        throw;
+    const std::string name = aSerum.full_name();
+    if (const auto* found = lookup_serum_of_chart(aSerum); found) {
+          // std::cerr << "find_in_hidb: " << name << " --> " << found->most_recent_table().table_id() << " tables:" << found->number_of_tables() << std::endl;
+        return *found;
     }
+    if (report_if_not_found) {
+        std::cerr << "ERROR: serum not found in hidb " << name << std::endl;
+        std::cerr << report(find_sera(name), "  ") << std::endl;
+    }
+    throw NotFound(name);
 
 } // HiDb::find_serum_of_chart
 
 // ----------------------------------------------------------------------
 
+std::vector<TiterRef> HiDb::titers_for(const AntigenData& aAntigen, const SerumData& aSerum) const
+{
+    std::vector<TiterRef> result;
+      // per_table() of both is sorted by table_id
+    auto ag_pt = aAntigen.per_table().begin(), sr_pt = aSerum.per_table().begin();
+    while (ag_pt != aAntigen.per_table().end() && sr_pt != aSerum.per_table().end()) {
+        if (*ag_pt < *sr_pt) {
+            ++ag_pt;
+        }
+        else if (*sr_pt < *ag_pt) {
+            ++sr_pt;
+        }
+        else {
+            if (ag_pt->index_in_table() != PerTable::NotInTable && sr_pt->index_in_table() != PerTable::NotInTable)
+                result.push_back({&mCharts[ag_pt->table_id()], ag_pt->index_in_table(), sr_pt->index_in_table()});
+            ++ag_pt;
+            ++sr_pt;
+        }
+    }
+    return result;
+
+} // HiDb::titers_for
+
+// ----------------------------------------------------------------------
+
+std::vector<AssayTiters> HiDb::hi_vs_neut_titers(std::string aLab) const
+{
+    Bitmap selected = mAntigenBitmaps.get(BitmapIndex::Assay, "HI") & mAntigenBitmaps.get(BitmapIndex::Assay, "NEUT");
+    if (!aLab.empty())
+        selected &= mAntigenBitmaps.get(BitmapIndex::Lab, aLab);
+
+    std::vector<AssayTiters> result;
+    std::map<ChartData::AgSrRef, size_t> serum_entry; // serum -> index in result for the current antigen
+    for (const auto* antigen: antigens_of(selected)) {
+        serum_entry.clear();
+        const auto antigen_first = result.size();
+        for (const auto& pt: antigen->per_table()) {
+            if (pt.index_in_table() == PerTable::NotInTable)
+                continue;
+            const auto& table = mCharts[pt.table_id()];
+            if (!aLab.empty() && table.chart_info().lab() != aLab)
+                continue;       // antigen may be in HI and neut tables of different labs, bitmaps select it then
+            const bool hi = table.chart_info().assay() == "HI";
+            for (size_t serum_no = 0; serum_no < table.number_of_sera(); ++serum_no) {
+                const auto [entry, inserted] = serum_entry.try_emplace(table.sera()[serum_no], result.size());
+                if (inserted)
+                    result.push_back({antigen, table.sera()[serum_no], {}, {}});
+                (hi ? result[entry->second].hi : result[entry->second].neut).push_back({&table, pt.index_in_table(), serum_no});
+            }
+        }
+        const auto first = result.begin() + static_cast<std::ptrdiff_t>(antigen_first);
+        result.erase(std::remove_if(first, result.end(), [](const auto& entry) { return entry.hi.empty() || entry.neut.empty(); }), result.end()); // serum in tables of one assay only
+        std::sort(result.begin() + static_cast<std::ptrdiff_t>(antigen_first), result.end(), [](const auto& a, const auto& b) { return a.serum < b.serum; });
+    }
+    return result;
+
+} // HiDb::hi_vs_neut_titers
+
+// ----------------------------------------------------------------------
+
+TiterStatistics HiDb::titer_statistics(const std::vector<std::string>& aTableIds) const
+{
+    std::vector<const ChartData*> tables; // in order of aTableIds, each table once
+    if (aTableIds.empty()) {
+        for (const auto& table: mCharts)
+            tables.push_back(&table);
+    }
+    else {
+        for (const auto& table_id: aTableIds) {
+            const auto* table = mCharts.find(table_id);
+            if (!table)
+                throw NotFound("titer_statistics: table " + table_id + " not in hidb");
+            if (std::find(tables.begin(), tables.end(), table) == tables.end())
+                tables.push_back(table);
+        }
+    }
+
+    std::map<const ChartData*, std::vector<size_t>> homologous; // table -> homologous antigen row for each serum column
+    for (const auto* table: tables)
+        homologous.emplace(table, std::vector<size_t>(table->number_of_sera(), PerTable::NotInTable));
+
+    for (const auto& serum: mSera) {
+        for (const auto& pt: serum.per_table()) {
+            if (pt.homologous().empty() || pt.index_in_table() == PerTable::NotInTable)
+                continue;
+            const auto& table = mCharts[pt.table_id()];
+            if (auto columns = homologous.find(&table); columns != homologous.end())
+                columns->second[pt.index_in_table()] = table.antigen_index_by_full_name(serum.data().name() + " " + pt.homologous());
+        }
+    }
+
+    TiterStatistics result;
+    for (const auto* table: tables)
+        result.add(*table, homologous[table]);
+    return result;
+
+} // HiDb::titer_statistics
+
+// ----------------------------------------------------------------------
+
 void HiDb::find_homologous_antigens_for_sera_of_chart(Chart& aChart) const
 {
     for (Serum& serum: aChart.sera()) {
-        try {
-            const SerumData& serum_data = find_serum_of_chart(serum);
-            const auto homologous = serum_data.homologous_variant_ids();
+        if (const auto* serum_data = lookup_serum_of_chart(serum); serum_data) {
+            const auto homologous = serum_data->homologous_variant_ids();
             if (!homologous.empty()) {
                 for (size_t antigen_index: aChart.antigens().find_by_name(serum.name())) {
                     const std::string v_id = variant_id(aChart.antigens()[antigen_index]);
@@ -751,8 +1547,6 @@ void HiDb::find_homologous_antigens_for_sera_of_chart(Chart& aChart) const
                 }
             }
         }
-        catch (NotFound&) {
-        }
     }
 
 } // HiDb::find_homologous_antigens_for_sera_of_chart
@@ -796,62 +1590,48 @@ std::vector<std::string> HiDb::unrecognized_locations() const
 
 // ----------------------------------------------------------------------
 
+  // Date of the first antigen having exactly the same name and isolation date
+  // (antigens are sorted by name), used both by make_stat_records() and
+  // update_stat_records(): the latter replaces serum records of added antigen
+  // names, i.e. exactly the sera whose date may have changed.
 std::string HiDb::serum_date(const SerumData& aSerum) const
 {
-    std::string date;
-    for (const auto& antigen: find_antigens_by_name(aSerum.name())) {
-        date = antigen->date();
-        if (!date.empty()) {
-            // if (date >= "2016")
-            //     std::cerr << aSerum.name() << " " << date << std::endl;
-            break;
-        }
+    const std::string name = aSerum.data().name();
+    for (auto antigen = std::lower_bound(mAntigens.begin(), mAntigens.end(), name, [](const auto& a, const std::string& b) { return a.data().name() < b; });
+         antigen != mAntigens.end() && antigen->data().name() == name; ++antigen) {
+        if (const auto date = antigen->date(); !date.empty())
+            return date;
     }
-    return date;
+    return {};
 
 } // HiDb::serum_date
 
 // ----------------------------------------------------------------------
 
-struct AntigenSerumInfo
-{
-    VirusType virus_type;
-    Lab lab;
-    YearMonth year_month;
-    Continent continent;
-    std::string lineage;
-
-    inline AntigenSerumInfo() = default;
-    inline operator bool() const { return !lab.empty(); }
-    inline void reset() { virus_type.clear(); lab.clear(); year_month.clear(); continent.clear(); lineage.clear(); }
-
-}; // struct AntigenSerumInfo
-
-template <typename AS> static void _stat_antigen_serum(AntigenSerumInfo& aInfo, const Tables& aCharts, const AS& aAntigenSerum, std::string aStart, std::string aEnd, std::function<std::string (const AS&)> aYearMonth)
+  // values of stat dimensions, continent and country are empty if location is not in locdb,
+  // virus type, lab and assay are of the first table of aAntigenSerum (see StatRecords)
+template <typename AS> static StatRecords::Values _stat_values(const Tables& aCharts, const AS& aAntigenSerum, std::string aYearMonth)
 {
+    StatRecords::Values values;
     const std::string name = aAntigenSerum.data().name();
     try {
-        aInfo.continent = get_locdb().continent(virus_name::location(name));
+        const auto location = virus_name::location(name);
+        values[StatRecords::Continent] = get_locdb().continent(location);
+        values[StatRecords::Country] = get_locdb().country(location);
     }
     catch (LocationNotFound&) {
     }
     catch (virus_name::Unrecognized& /*err*/) {
           // std::cerr << "ERROR: " << err.what() << std::endl;
     }
-    if (!aInfo.continent.empty()) {                      // Unknown continent not counted to avoid stat inconsistency and questions
-        aInfo.year_month = aYearMonth(aAntigenSerum);
-        aStart = aStart.substr(0, 6); // just year-month
-        aEnd = aEnd.substr(0, 6); // just year-month
-        if ((aStart.empty() || (!aInfo.year_month.empty() && aInfo.year_month >= aStart)) && (aEnd.empty() || (!aInfo.year_month.empty() && aInfo.year_month < aEnd))) {
-            if (aInfo.year_month.empty())
-                aInfo.year_month = "????";
-            const auto& table = aCharts[aAntigenSerum.per_table().front().table_id()].chart_info();
-            aInfo.virus_type = table.virus_type();
-            aInfo.lab = table.lab();
-            if (aInfo.virus_type == "B")
-                aInfo.lineage = aAntigenSerum.data().lineage();
-        }
-    }
+    values[StatRecords::YearMonth] = aYearMonth;
+    const auto& table = aCharts[aAntigenSerum.per_table().front().table_id()].chart_info();
+    values[StatRecords::VirusType] = table.virus_type();
+    values[StatRecords::Lab] = table.lab();
+    values[StatRecords::Assay] = table.assay();
+    if (values[StatRecords::VirusType] == "B")
+        values[StatRecords::Lineage] = aAntigenSerum.data().lineage();
+    return values;
 }
 
 // ----------------------------------------------------------------------
@@ -883,62 +1663,217 @@ static inline std::string _year_month(std::string date, std::string name /* , bo
 
 // ----------------------------------------------------------------------
 
-static inline void _update_stat(const AntigenSerumInfo& aInfo, HiDbStat& aStat)
+  // records with year-month in [aStart, aEnd), records without year-month are selected only if range is unlimited
+static inline Bitmap _select_date_range(const StatRecords& aRecords, std::string aStart, std::string aEnd)
 {
-    if (aInfo) {
-        ++aStat[aInfo.virus_type][aInfo.lab][aInfo.year_month][aInfo.continent];
-        ++aStat["all"][aInfo.lab][aInfo.year_month][aInfo.continent];
-        if (!aInfo.lineage.empty())
-            ++aStat[aInfo.virus_type + aInfo.lineage][aInfo.lab][aInfo.year_month][aInfo.continent];
-    }
+    aStart = _fix_date(aStart).substr(0, 6); // just year-month
+    aEnd = _fix_date(aEnd).substr(0, 6); // just year-month
+    return aRecords.select(StatRecords::YearMonth, [&aStart, &aEnd](const std::string& year_month) -> bool {
+        return (aStart.empty() || (!year_month.empty() && year_month >= aStart)) && (aEnd.empty() || (!year_month.empty() && year_month < aEnd));
+    });
+}
+
+static inline Bitmap _stat_selection(const StatRecords& aRecords, std::string aStart, std::string aEnd)
+{
+    auto selected = _select_date_range(aRecords, aStart, aEnd);
+    selected &= aRecords.select(StatRecords::Continent, [](const std::string& continent) -> bool { return !continent.empty(); }); // Unknown continent not counted to avoid stat inconsistency and questions
+    selected &= aRecords.select(StatRecords::Lab, [](const std::string& lab) -> bool { return !lab.empty(); });
+    return selected;
 }
 
 // ----------------------------------------------------------------------
 
-void HiDb::stat_antigens(HiDbStat& aStat, std::string aStart, std::string aEnd) const
+  // counts are taken from cube cells, i.e. it does not depend on the number of antigens/sera
+static inline void _update_stat(const StatCube& aCube, std::string aStart, std::string aEnd, HiDbStat& aStat)
+{
+    const auto& cells = aCube.cells();
+    GroupBy(cells, {StatRecords::VirusType, StatRecords::Lineage, StatRecords::Lab, StatRecords::YearMonth, StatRecords::Continent}, _stat_selection(cells, aStart, aEnd), true).for_each([&aStat](const GroupBy::Key& key, size_t count) {
+        const auto& virus_type = key[0];
+        const auto& lineage = key[1];
+        const auto& lab = key[2];
+        const std::string year_month = key[3].empty() ? "????"s : key[3];
+        const auto& continent = key[4];
+        aStat[virus_type][lab][year_month][continent] += count;
+        aStat["all"][lab][year_month][continent] += count;
+        if (!lineage.empty())
+            aStat[virus_type + lineage][lab][year_month][continent] += count;
+    });
+}
+
+static inline std::vector<StatRecords::Dimension> _stat_dimensions(const std::vector<std::string>& aDimensions)
+{
+    std::vector<StatRecords::Dimension> result;
+    std::transform(aDimensions.begin(), aDimensions.end(), std::back_inserter(result), &StatRecords::dimension);
+    return result;
+}
+
+static inline std::map<GroupBy::Key, size_t> _group_by(const StatCube& aCube, const std::vector<std::string>& aDimensions, std::string aStart, std::string aEnd)
+{
+    const auto& cells = aCube.cells();
+    return GroupBy(cells, _stat_dimensions(aDimensions), _select_date_range(cells, aStart, aEnd), true).counts();
+}
+
+  // aFirst is the first antigen/serum with its name (antigens and sera are sorted by name)
+template <typename Iter> static inline Iter _end_of_name(Iter aFirst, Iter aLast)
+{
+    return std::find_if(aFirst, aLast, [&aFirst](const auto& entry) -> bool { return entry.data().name() != aFirst->data().name(); });
+}
+
+// ----------------------------------------------------------------------
+
+void HiDb::make_stat_records() const
+{
+    mAntigenStat.clear();
+    for (auto antigen = mAntigens.begin(); antigen != mAntigens.end(); antigen = _end_of_name(antigen, mAntigens.end())) {
+        const std::string name = antigen->data().name();
+        mAntigenStat.put(name, _stat_values(mCharts, *antigen, _year_month(antigen->date(), name)));
+    }
+
+    mSerumStat.clear();
+    for (auto serum = mSera.begin(); serum != mSera.end(); ) {
+        const std::string name = serum->data().name();
+        const auto end_of_name = _end_of_name(serum, mSera.end());
+        mSerumStat.put(name, _stat_values(mCharts, *serum, _year_month(serum_date(*serum), name)), static_cast<size_t>(end_of_name - serum));
+        serum = end_of_name;
+    }
+    mAntigenCube.make(mAntigenStat);
+    mSerumCube.make(mSerumStat);
+    mSerumNameCube.make(mSerumStat, false);
+    mStatAddedAntigens.clear();
+    mStatAddedSera.clear();
+    mStatRecordsOutdated = false;
+    mStatRecordsMade = true;
+
+} // HiDb::make_stat_records
+
+// ----------------------------------------------------------------------
+
+  // Double checked: the flag is set by make_stat_records() and update_stat_records()
+  // after records are made, readers seeing it set do not lock.
+void HiDb::prepare_stat() const
 {
-    aStart = _fix_date(aStart);
-    aEnd = _fix_date(aEnd);
-
-    std::string previous_name;
-    for (const auto& antigen: antigens()) {
-        const std::string name = antigen.data().name();
-        if (name != previous_name) {
-            AntigenSerumInfo info;
-            _stat_antigen_serum<AntigenData>(info, mCharts, antigen, aStart, aEnd, [&name](const AntigenData& ag) -> std::string { return _year_month(ag.date(), name); });
-            _update_stat(info, aStat);
-            previous_name = name;
+    if (!mStatRecordsMade) {
+        std::unique_lock<std::mutex> lock{mStatMutex};
+        if (!mStatRecordsMade) {
+            if (mStatRecordsOutdated)
+                update_stat_records();
+            else
+                make_stat_records();
         }
     }
 
-} // HiDb::stat_antigens
+} // HiDb::prepare_stat
 
 // ----------------------------------------------------------------------
 
-void HiDb::stat_sera(HiDbStat& aStat, HiDbStat* aStatUnique, std::string aStart, std::string aEnd) const
+  // Records of names added by add() since records were made are replaced. Serum
+  // date is the date of an antigen with the same name (see serum_date()), i.e.
+  // serum records of added antigen names are replaced too. Values are obtained before
+  // cubes are adjusted, if locdb is not available, nothing is changed and update
+  // is tried again by the next prepare_stat().
+void HiDb::update_stat_records() const
 {
-    aStart = _fix_date(aStart);
-    aEnd = _fix_date(aEnd);
-
-    std::string previous_name;
-    AntigenSerumInfo info;
-    for (const auto& serum: sera()) {
-        const std::string name = serum.data().name();
-        if (name != previous_name) {
-            info.reset();
-            _stat_antigen_serum<SerumData>(info, mCharts, serum, aStart, aEnd, [&name,this](const auto& sr) -> std::string { return _year_month(this->serum_date(sr), name); });
-            _update_stat(info, aStat);
-            previous_name = name;
+    auto by_name = [](const auto& a, const std::string& b) -> bool { return a.data().name() < b; };
+
+    for (const auto& name: mStatAddedAntigens) {
+        if (const auto antigen = std::lower_bound(mAntigens.begin(), mAntigens.end(), name, by_name); antigen != mAntigens.end() && antigen->data().name() == name) {
+            const auto values = _stat_values(mCharts, *antigen, _year_month(antigen->date(), name));
+            if (const auto record_no = mAntigenStat.find(name); record_no != StatRecords::NotFound)
+                mAntigenCube.adjust(mAntigenStat.values(record_no), -static_cast<long>(mAntigenStat.weight(record_no)));
+            mAntigenStat.put(name, values);
+            mAntigenCube.adjust(values, 1);
         }
-        if (aStatUnique) {
-            _update_stat(info, *aStatUnique);
+    }
+
+    std::set<std::string> serum_names{mStatAddedSera};
+    serum_names.insert(mStatAddedAntigens.begin(), mStatAddedAntigens.end()); // serum date may change
+    for (const auto& name: serum_names) {
+        if (const auto serum = std::lower_bound(mSera.begin(), mSera.end(), name, by_name); serum != mSera.end() && serum->data().name() == name) {
+            const auto values = _stat_values(mCharts, *serum, _year_month(serum_date(*serum), name));
+            const auto weight = static_cast<size_t>(_end_of_name(serum, mSera.end()) - serum);
+            if (const auto record_no = mSerumStat.find(name); record_no != StatRecords::NotFound) {
+                mSerumCube.adjust(mSerumStat.values(record_no), -static_cast<long>(mSerumStat.weight(record_no)));
+                mSerumNameCube.adjust(mSerumStat.values(record_no), -1);
+            }
+            mSerumStat.put(name, values, weight);
+            mSerumCube.adjust(values, static_cast<long>(weight));
+            mSerumNameCube.adjust(values, 1);
         }
     }
 
+    mStatAddedAntigens.clear();
+    mStatAddedSera.clear();
+    mStatRecordsOutdated = false;
+    mStatRecordsMade = true;
+
+} // HiDb::update_stat_records
+
+// ----------------------------------------------------------------------
+
+  // weights are not stored in hidb file, they are the number of sera with the same name
+void HiDb::set_serum_stat_weights()
+{
+    for (auto serum = mSera.begin(); serum != mSera.end(); ) {
+        const auto end_of_name = _end_of_name(serum, mSera.end());
+        if (const auto record_no = mSerumStat.find(serum->data().name()); record_no != StatRecords::NotFound)
+            mSerumStat.set_weight(record_no, static_cast<size_t>(end_of_name - serum));
+        serum = end_of_name;
+    }
+
+} // HiDb::set_serum_stat_weights
+
+// ----------------------------------------------------------------------
+
+void HiDb::stat_antigens(HiDbStat& aStat, std::string aStart, std::string aEnd) const
+{
+    prepare_stat();
+    _update_stat(mAntigenCube, aStart, aEnd, aStat);
+
+} // HiDb::stat_antigens
+
+// ----------------------------------------------------------------------
+
+void HiDb::stat_sera(HiDbStat& aStat, HiDbStat* aStatUnique, std::string aStart, std::string aEnd) const
+{
+    prepare_stat();
+    _update_stat(mSerumNameCube, aStart, aEnd, aStat);
+    if (aStatUnique)
+        _update_stat(mSerumCube, aStart, aEnd, *aStatUnique);
+
 } // HiDb::stat_sera
 
 // ----------------------------------------------------------------------
 
+std::map<GroupBy::Key, size_t> HiDb::stat_antigens_by(const std::vector<std::string>& aDimensions, std::string aStart, std::string aEnd) const
+{
+    prepare_stat();
+    return _group_by(mAntigenCube, aDimensions, aStart, aEnd);
+
+} // HiDb::stat_antigens_by
+
+// ----------------------------------------------------------------------
+
+std::map<GroupBy::Key, size_t> HiDb::stat_sera_by(const std::vector<std::string>& aDimensions, bool aUnique, std::string aStart, std::string aEnd) const
+{
+    prepare_stat();
+    return _group_by(aUnique ? mSerumCube : mSerumNameCube, aDimensions, aStart, aEnd);
+
+} // HiDb::stat_sera_by
+
+// ----------------------------------------------------------------------
+
+std::map<GroupBy::Key, size_t> HiDb::stat_antigens_cube(const std::vector<std::string>& aDimensions, const std::map<std::string, std::vector<std::string>>& aFilter, std::string aStart, std::string aEnd) const
+{
+    prepare_stat();
+    StatCube::Filter filter;
+    for (const auto& [dimension, values]: aFilter)
+        filter[StatRecords::dimension(dimension)].insert(values.begin(), values.end());
+    return mAntigenCube.slice(_stat_dimensions(aDimensions), filter, aStart, aEnd);
+
+} // HiDb::stat_antigens_cube
+
+// ----------------------------------------------------------------------
+
 void HiDbStat::compute_totals()
 {
     auto continent_sum = [](size_t sum, const auto& continent_count) -> size_t { return sum + continent_count.second; };
@@ -973,6 +1908,22 @@ void HiDbStat::compute_totals()
 
 // ----------------------------------------------------------------------
 
+void HiDbStat::add(const HiDbStat& aNother)
+{
+    for (const auto& [virus_type, labs]: aNother) {
+        for (const auto& [lab, dates]: labs) {
+            for (const auto& [year_month, continents]: dates) {
+                auto& target = (*this)[virus_type][lab][year_month];
+                for (const auto& [continent, count]: continents)
+                    target[continent] += count;
+            }
+        }
+    }
+
+} // HiDbStat::add
+
+// ----------------------------------------------------------------------
+
 namespace hidb
 {
 
@@ -982,9 +1933,6 @@ namespace hidb
 #pragma GCC diagnostic ignored "-Wexit-time-destructors"
 #endif
 
-    class HiDbSet;
-
-    static std::unique_ptr<HiDbSet> sHiDbSet;
     static std::string sHiDbDir = std::getenv("HOME") + "/AD/data"s;
     static bool sVerbose = false;
 
@@ -1006,44 +1954,174 @@ namespace hidb
      public:
         const HiDb& get(std::string aVirusType, report_time timer = report_time::No) const
             {
-                auto h = mPtrs.find(aVirusType);
-                if (h == mPtrs.end()) {
-                    std::string filename;
-                    if (aVirusType == "A(H1N1)" || aVirusType == "H1")
-                        filename = sHiDbDir + "/hidb4.h1.json.xz";
-                    else if (aVirusType == "A(H3N2)" || aVirusType == "H3")
-                        filename = sHiDbDir + "/hidb4.h3.json.xz";
-                    else if (aVirusType == "B")
-                        filename = sHiDbDir + "/hidb4.b.json.xz";
-                    else
-                        throw NoHiDb{};
-                      //throw std::runtime_error("No HiDb for " + aVirusType);
+                return *future_of(canonical_virus_type(aVirusType), timer).get();
+            }
 
-                    std::unique_ptr<HiDb> hidb{new HiDb{}};
-                    hidb->importFrom(filename, sVerbose ? report_time::Yes : timer);
-                    h = mPtrs.emplace(aVirusType, std::move(hidb)).first;
-                }
-                return *h->second;
+          // all hidbs in sVirusTypes order, missing ones are loaded concurrently
+        std::vector<std::pair<std::string, const HiDb*>> all(report_time timer = report_time::No) const
+            {
+                std::vector<std::future<const HiDb*>> loading;
+                for (const auto* virus_type: sVirusTypes)
+                    loading.push_back(std::async(loading_started(virus_type) ? std::launch::deferred : std::launch::async, [this, virus_type, timer]() -> const HiDb* { return future_of(virus_type, timer).get().get(); }));
+                std::vector<std::pair<std::string, const HiDb*>> result;
+                for (size_t no = 0; no < loading.size(); ++no)
+                    result.emplace_back(sVirusTypes[no], loading[no].get());
+                return result;
             }
 
      private:
-        using Ptrs = std::map<std::string, std::unique_ptr<hidb::HiDb>>;
+        using Loaded = std::shared_future<std::unique_ptr<hidb::HiDb>>;
+
+        mutable std::mutex mMutex;   // held just to find or insert in mLoaded, not while loading
+        mutable std::map<std::string, Loaded> mLoaded;
+
+          // the first request of aVirusType loads it in the calling thread, concurrent requests wait for the future
+        Loaded future_of(std::string aVirusType, report_time timer) const
+            {
+                std::unique_lock<std::mutex> lock{mMutex};
+                if (const auto found = mLoaded.find(aVirusType); found != mLoaded.end())
+                    return found->second;
+                std::packaged_task<std::unique_ptr<HiDb> ()> task([this, aVirusType, timer]() -> std::unique_ptr<HiDb> {
+                    try {
+                        return load(aVirusType, timer);
+                    }
+                    catch (...) {
+                        std::unique_lock<std::mutex> lock_failed{mMutex};
+                        mLoaded.erase(aVirusType); // the next request tries again
+                        throw;
+                    }
+                });
+                const auto loaded = mLoaded.emplace(aVirusType, task.get_future().share()).first->second;
+                lock.unlock();
+                task();
+                return loaded;
+            }
+
+        bool loading_started(std::string aVirusType) const
+            {
+                std::unique_lock<std::mutex> lock{mMutex};
+                return mLoaded.find(aVirusType) != mLoaded.end();
+            }
+
+        static constexpr const char* sVirusTypes[] = {"A(H1N1)", "A(H3N2)", "B"};
+
+        static std::string canonical_virus_type(std::string aVirusType)
+            {
+                if (aVirusType == "A(H1N1)" || aVirusType == "H1")
+                    return "A(H1N1)";
+                else if (aVirusType == "A(H3N2)" || aVirusType == "H3")
+                    return "A(H3N2)";
+                else if (aVirusType == "B")
+                    return "B";
+                else
+                    throw NoHiDb{};
+                      //throw std::runtime_error("No HiDb for " + aVirusType);
+            }
 
-        mutable Ptrs mPtrs;
+        static std::unique_ptr<HiDb> load(std::string aVirusType, report_time timer)
+            {
+                std::string filename;
+                if (aVirusType == "A(H1N1)")
+                    filename = sHiDbDir + "/hidb4.h1.json.xz";
+                else if (aVirusType == "A(H3N2)")
+                    filename = sHiDbDir + "/hidb4.h3.json.xz";
+                else
+                    filename = sHiDbDir + "/hidb4.b.json.xz";
+                auto hidb = std::make_unique<HiDb>();
+                hidb->importFrom(filename, sVerbose ? report_time::Yes : timer);
+                return hidb;
+            }
 
     }; // class HiDbSet
+
+#pragma GCC diagnostic push
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Wexit-time-destructors"
+#endif
+
+    static HiDbSet& hidb_set()
+    {
+        static HiDbSet sHiDbSet; // initialization is thread safe
+        return sHiDbSet;
+    }
+
+#pragma GCC diagnostic pop
 }
 
 // ----------------------------------------------------------------------
 
 const hidb::HiDb& hidb::get(std::string aVirusType, report_time timer)
 {
-    if (!sHiDbSet)
-        sHiDbSet = std::make_unique<HiDbSet>();
-    return sHiDbSet->get(aVirusType, timer);
+    return hidb_set().get(aVirusType, timer);
 
 } // hidb::get
 
+// ----------------------------------------------------------------------
+
+template <typename Data> static std::vector<hidb::FoundIn<Data>> find_everywhere(report_time timer, std::function<std::vector<const Data*> (const HiDb&)> aFind)
+{
+    get_locdb();                // finders look up locations, load locdb before it is shared by the threads below
+    const auto hidbs = hidb_set().all(timer);
+    std::vector<std::future<std::vector<const Data*>>> found;
+    for (const auto& [virus_type, hidb]: hidbs)
+        found.push_back(std::async(std::launch::async, aFind, std::cref(*hidb)));
+    std::vector<hidb::FoundIn<Data>> result;
+    for (size_t no = 0; no < hidbs.size(); ++no) {
+        for (const auto* data: found[no].get())
+            result.push_back({hidbs[no].first, data});
+    }
+    return result;
+
+} // find_everywhere
+
+// ----------------------------------------------------------------------
+
+std::vector<hidb::FoundIn<AntigenData>> hidb::find_antigens_everywhere(std::string name_reassortant_annotations_passage, report_time timer)
+{
+    return find_everywhere<AntigenData>(timer, [&](const HiDb& hidb) { return hidb.find_antigens(name_reassortant_annotations_passage); });
+
+} // hidb::find_antigens_everywhere
+
+// ----------------------------------------------------------------------
+
+std::vector<hidb::FoundIn<AntigenData>> hidb::find_antigen_exactly_everywhere(std::string name_reassortant_annotations_passage, report_time timer)
+{
+    return find_everywhere<AntigenData>(timer, [&](const HiDb& hidb) -> std::vector<const AntigenData*> {
+        if (const auto lookup = hidb.lookup_antigen_exactly(name_reassortant_annotations_passage); lookup)
+            return {lookup.found};
+        return {};
+    });
+
+} // hidb::find_antigen_exactly_everywhere
+
+// ----------------------------------------------------------------------
+
+std::vector<hidb::FoundIn<AntigenData>> hidb::find_antigens_fuzzy_everywhere(std::string name_reassortant_annotations_passage, report_time timer)
+{
+    return find_everywhere<AntigenData>(timer, [&](const HiDb& hidb) { return hidb.find_antigens_fuzzy(name_reassortant_annotations_passage); });
+
+} // hidb::find_antigens_fuzzy_everywhere
+
+// ----------------------------------------------------------------------
+
+std::vector<hidb::FoundIn<SerumData>> hidb::find_sera_everywhere(std::string name, report_time timer)
+{
+    return find_everywhere<SerumData>(timer, [&](const HiDb& hidb) { return hidb.find_sera(name); });
+
+} // hidb::find_sera_everywhere
+
+// ----------------------------------------------------------------------
+
+std::vector<hidb::FoundIn<SerumData>> hidb::find_serum_exactly_everywhere(std::string name_reassortant_annotations_serum_id, report_time timer)
+{
+    return find_everywhere<SerumData>(timer, [&](const HiDb& hidb) -> std::vector<const SerumData*> {
+        if (const auto* found = hidb.lookup_serum_exactly(name_reassortant_annotations_serum_id); found)
+            return {found};
+        return {};
+    });
+
+} // hidb::find_serum_exactly_everywhere
+
 // ----------------------------------------------------------------------
 /// Local Variables:
 /// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
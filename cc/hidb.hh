@@ -5,11 +5,29 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <string_view>
+#include <array>
 #include <algorithm>
 #include <optional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <type_traits>
 
 #include "acmacs-base/timeit.hh"
 #include "acmacs-chart-1/chart.hh"
+#include "acmacs-chart-1/antigen-serum-match.hh"
+#include "hidb-bitmap.hh"
+#include "bloom-filter.hh"
+#include "interned-string.hh"
+#include "prefix-index.hh"
+#include "titers.hh"
+#include "titer-stat.hh"
+#include "hidb-stat.hh"
+#include "variant-id.hh"
 
 // ----------------------------------------------------------------------
 
@@ -17,36 +35,51 @@ namespace hidb
 {
 
     class HiDb;
+    class VaccineIndex;
+    class LocationDateIndex;
+
+    using LabMask = uint32_t;   // bit per lab, see HiDb::lab_mask()
+    constexpr const size_t LabMaskBits = sizeof(LabMask) * 8; // labs after the first LabMaskBits ones are looked up in tables
+    enum AssayMask : uint8_t { AssayHI = 1, AssayNeut = 2 };
 
 // ----------------------------------------------------------------------
 
     class PerTable
     {
      public:
+        using LabIds = std::vector<InternedString>;
+
         inline PerTable() = default;
-        inline PerTable(std::string aTableId, const Antigen& aAntigen) : mTableId(aTableId), mDate(aAntigen.date()), mLabId(aAntigen.lab_id()) {}
+        inline PerTable(std::string aTableId, const Antigen& aAntigen) : mTableId(aTableId), mDate(aAntigen.date()), mLabId(aAntigen.lab_id().begin(), aAntigen.lab_id().end()) {}
         inline PerTable(std::string aTableId, const Serum& /*aSerum*/) : mTableId(aTableId) {}
 
-        inline const std::string table_id() const { return mTableId; }
-        inline std::string& table_id() { return mTableId; }
-        inline const std::string date() const { return mDate; } // date of an antigen in that table! (NOT date of a table!)
-        inline std::string& date() { return mDate; }
-        inline const std::vector<std::string>& lab_id() const { return mLabId; }
-        inline std::vector<std::string>& lab_id() { return mLabId; }
-        inline bool has_lab_id(std::string aLabId) const { return std::find(mLabId.begin(), mLabId.end(), aLabId) != mLabId.end(); }
-        inline const std::string homologous() const { return mHomologous; }
-        inline std::string& homologous() { return mHomologous; }
+          // fields are interned, equality of them (e.g. has_lab_id(InternedString)) is a pointer compare
+        inline const std::string& table_id() const { return mTableId; }
+        inline InternedString& table_id_ref() { return mTableId; }
+        inline const std::string& date() const { return mDate; } // date of an antigen in that table! (NOT date of a table!)
+        inline InternedString& date_ref() { return mDate; }
+        inline const LabIds& lab_id() const { return mLabId; }
+        inline LabIds& lab_id_ref() { return mLabId; }
+        inline bool has_lab_id(InternedString aLabId) const { return std::find(mLabId.begin(), mLabId.end(), aLabId) != mLabId.end(); }
+        inline const std::string& homologous() const { return mHomologous; }
+        inline InternedString& homologous_ref() { return mHomologous; }
+        inline InternedString homologous_interned() const { return mHomologous; }
 
         inline void set_homologous(std::string aHomologous) { mHomologous = aHomologous; }
+          // row of the antigen or column of the serum in that table, resolved by AntigenSerumData::update_summary()
+        static constexpr const size_t NotInTable = static_cast<uint32_t>(-1);
+        inline size_t index_in_table() const { return mIndexInTable; }
+        inline void set_index_in_table(size_t aIndex) { mIndexInTable = static_cast<uint32_t>(aIndex); }
 
         inline bool operator < (const PerTable& aNother) const { return mTableId < aNother.mTableId; }
-        inline bool operator < (const std::string& aTableId) const { return mTableId < aTableId; }
+        inline bool operator < (const std::string& aTableId) const { return mTableId.str() < aTableId; }
 
      private:
-        std::string mTableId;
-        std::string mDate;
-        std::vector<std::string> mLabId;
-        std::string mHomologous;    // variant_id of the homologous antigen
+        InternedString mTableId;
+        InternedString mDate;
+        LabIds mLabId;
+        InternedString mHomologous;    // variant_id of the homologous antigen
+        uint32_t mIndexInTable = NotInTable;
     };
 
 // ----------------------------------------------------------------------
@@ -94,14 +127,21 @@ namespace hidb
         inline const std::vector<PerTable>& per_table() const { return mTables; }
         inline std::vector<PerTable>& per_table() { return mTables; }
         inline size_t number_of_tables() const { return mTables.size(); }
-        inline const PerTable& most_recent_table() const { return *std::max_element(mTables.begin(), mTables.end()); }
-        inline const PerTable& oldest_table() const { return *std::min_element(mTables.begin(), mTables.end()); }
-        inline bool has_lab_id(std::string aLabId) const { return std::any_of(mTables.begin(), mTables.end(), [&](const auto& e) -> bool { return e.has_lab_id(aLabId); }); }
+        inline const PerTable& most_recent_table() const { return mTables[mMostRecentTable]; }
+        inline const PerTable& oldest_table() const { return mTables[mOldestTable]; }
+          // callers testing many antigens/sera intern lab id once (InternedString::existing()) and use the second overload
+        inline bool has_lab_id(std::string aLabId) const { const auto lab_id = InternedString::existing(aLabId); return lab_id && has_lab_id(*lab_id); }
+        inline bool has_lab_id(InternedString aLabId) const { return std::any_of(mTables.begin(), mTables.end(), [aLabId](const auto& e) -> bool { return e.has_lab_id(aLabId); }); }
         inline std::string lineage() const { return mData.lineage(); }
         void labs(const HiDb& aHiDb, std::vector<std::string>& aLabs) const;
         bool has_lab(const HiDb& aHiDb, std::string aLab) const;
-        bool in_hi_assay(const HiDb& aHiDb) const;
-        bool in_neut_assay(const HiDb& aHiDb) const;
+        inline LabMask lab_mask() const { return mLabs; }
+        inline bool in_hi_assay(const HiDb& /*aHiDb*/) const { return mAssays & AssayHI; }
+        inline bool in_neut_assay(const HiDb& /*aHiDb*/) const { return mAssays & AssayNeut; }
+
+          // recomputes most recent/oldest table, date, labs and assays from per_table() and resolves index
+          // of antigen/serum in each table, must be called after per_table() is changed
+        void update_summary(const HiDb& aHiDb);
 
         inline std::vector<std::pair<std::string, std::string>> homologous() const
             {
@@ -126,21 +166,25 @@ namespace hidb
             }
 
           // returns if serum has passed variant_id among variant ids of its homologous antigens
-        inline bool has_homologous_variant_id(std::string variant_id) const
+        inline bool has_homologous_variant_id(std::string variant_id) const { const auto interned = InternedString::existing(variant_id); return interned && has_homologous_variant_id(*interned); }
+        inline bool has_homologous_variant_id(InternedString variant_id) const
             {
-                return std::find_if(mTables.begin(), mTables.end(), [&variant_id](const auto& t) -> bool { return t.homologous() == variant_id; }) != mTables.end();
+                return std::find_if(mTables.begin(), mTables.end(), [variant_id](const auto& t) -> bool { return t.homologous_interned() == variant_id; }) != mTables.end();
             }
 
           // returns isolation date (or empty string, if not available), if multiple dates are found in different tables, returns the most recent date
-        inline std::string date() const
-            {
-                return mTables.empty() ? std::string() : std::max_element(mTables.begin(), mTables.end(), [](const auto& a, const auto& b) { return a.date() < b.date(); })->date();
-            }
+        inline std::string date() const { return mDate; }
 
      private:
         AS mData;
         std::vector<PerTable> mTables;
 
+          // summary of mTables, see update_summary()
+        std::string mDate;
+        uint32_t mMostRecentTable = 0, mOldestTable = 0; // indices in mTables
+        LabMask mLabs = 0;
+        uint8_t mAssays = 0;    // AssayMask bits
+
     }; // class AntigenSerumData<>
 
     using AntigenData = AntigenSerumData<Antigen>;
@@ -148,11 +192,34 @@ namespace hidb
 
 // ----------------------------------------------------------------------
 
-    class ChartData
+      // full name ("name variant_id") -> index in ChartData antigens or sera, looked up without building full names
+    class FullNameIndex
     {
      public:
         using AgSrRef = std::pair<std::string, std::string>;
-        using Titers = std::vector<std::vector<std::string>>;
+
+        void make(const std::vector<AgSrRef>& aRefs);
+        size_t find(const std::vector<AgSrRef>& aRefs, std::string_view aFullName) const; // returns -1 if not found
+
+     private:
+        std::unordered_multimap<size_t, size_t> mIndex; // hash of full name -> index
+
+        static size_t hash(std::string_view aData, size_t aHash = 14695981039346656037ULL); // FNV-1a, aHash allows continuing
+        static inline bool match(const AgSrRef& aRef, std::string_view aFullName)
+            {
+                return aFullName.size() == (aRef.first.size() + aRef.second.size() + 1) && aFullName.substr(0, aRef.first.size()) == aRef.first
+                        && aFullName[aRef.first.size()] == ' ' && aFullName.substr(aRef.first.size() + 1) == aRef.second;
+            }
+
+    }; // class FullNameIndex
+
+// ----------------------------------------------------------------------
+
+    class ChartData
+    {
+     public:
+        using AgSrRef = FullNameIndex::AgSrRef;
+        using Titers = TiterMatrix;
 
         inline ChartData() = default;
         ChartData(const Chart& aChart);
@@ -164,7 +231,7 @@ namespace hidb
         inline const std::vector<AgSrRef>& antigens() const { return mAntigens; }
         inline const std::vector<AgSrRef>& sera() const { return mSera; }
         inline const Titers& titers() const { return mTiters; }
-        inline std::string titer(size_t antigen_no, size_t serum_no) const { return titers()[antigen_no][serum_no]; }
+        inline std::string titer(size_t antigen_no, size_t serum_no) const { return mTiters.titer(antigen_no, serum_no); }
 
         inline std::string& table_id() { return mTableId; }
         inline ChartInfo& chart_info() { return mChartInfo; }
@@ -174,7 +241,10 @@ namespace hidb
 
         inline bool operator <(const ChartData& aNother) const { return table_id() < aNother.table_id(); }
 
-        size_t antigen_index_by_full_name(std::string full_name) const; // returns -1 if not found
+          // make_index() must be called after antigens() or sera() are modified, otherwise lookups fall back to scanning
+        void make_index();
+        inline size_t antigen_index_by_full_name(std::string full_name) const { return mAntigenIndex.find(mAntigens, full_name); } // returns -1 if not found
+        inline size_t serum_index_by_full_name(std::string full_name) const { return mSerumIndex.find(mSera, full_name); } // returns -1 if not found
         inline std::string antigen_full_name(size_t index) const { const auto& ag = mAntigens[index]; return ag.first + " " + ag.second; }
         inline std::string serum_full_name(size_t index) const { const auto& sr = mSera[index]; return sr.first + " " + sr.second; }
 
@@ -184,32 +254,113 @@ namespace hidb
         std::vector<AgSrRef> mAntigens;
         std::vector<AgSrRef> mSera;
         Titers mTiters;
+        FullNameIndex mAntigenIndex;
+        FullNameIndex mSerumIndex;
 
     }; // class ChartData
 
 // ----------------------------------------------------------------------
 
-    class Tables : public std::vector<ChartData>
+      // ChartData objects are allocated individually and never moved, pointers to
+      // them remain valid when tables are added. Iteration is in table_id order
+      // using the sorted index, lookup by table_id uses the hash index.
+      // Copy shares ChartData objects with the source, they are not modified
+      // after import or add (see VersionedHiDb).
+    class Tables
     {
+     private:
+        using Sorted = std::vector<ChartData*>;
+
      public:
-        inline auto insert_pos(const ChartData& aChart)
+        template <typename CD> class iterator_t
+        {
+         public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = ChartData;
+            using difference_type = std::ptrdiff_t;
+            using pointer = CD*;
+            using reference = CD&;
+
+            inline iterator_t(Sorted::const_iterator aIter) : mIter(aIter) {}
+            inline reference operator*() const { return **mIter; }
+            inline pointer operator->() const { return *mIter; }
+            inline iterator_t& operator++() { ++mIter; return *this; }
+            inline iterator_t& operator--() { --mIter; return *this; }
+            inline iterator_t& operator+=(difference_type aOffset) { mIter += aOffset; return *this; }
+            inline iterator_t operator+(difference_type aOffset) const { return mIter + aOffset; }
+            inline difference_type operator-(const iterator_t& aNother) const { return mIter - aNother.mIter; }
+            inline reference operator[](difference_type aOffset) const { return *mIter[aOffset]; }
+            inline bool operator==(const iterator_t& aNother) const { return mIter == aNother.mIter; }
+            inline bool operator!=(const iterator_t& aNother) const { return mIter != aNother.mIter; }
+            inline bool operator<(const iterator_t& aNother) const { return mIter < aNother.mIter; }
+
+         private:
+            Sorted::const_iterator mIter;
+        };
+
+        using iterator = iterator_t<ChartData>;
+        using const_iterator = iterator_t<const ChartData>;
+
+        inline size_t size() const { return mStorage.size(); }
+        inline bool empty() const { return mStorage.empty(); }
+        inline const_iterator begin() const { return mSorted.begin(); }
+        inline const_iterator end() const { return mSorted.end(); }
+        inline iterator begin() { return mSorted.cbegin(); }
+        inline iterator end() { return mSorted.cend(); }
+        inline const ChartData& front() const { return *mSorted.front(); }
+
+          // used by import, table is filled in place, make_index() must be called when all tables are read
+        inline ChartData& emplace_back() { return *mStorage.emplace_back(std::make_shared<ChartData>()); }
+        inline ChartData& back() { return *mStorage.back(); }
+        void make_index();
+
+          // throws if table with the same table_id is already there
+        const ChartData& add(ChartData&& aChart);
+
+        inline const ChartData* find(std::string aTableId) const
             {
-                const auto chart_insert_at = std::lower_bound(begin(), end(), aChart);
-                if (chart_insert_at != end() && chart_insert_at->table_id() == aChart.table_id())
-                    throw std::runtime_error("Chart " + aChart.table_id() + " already in hidb");
-                return chart_insert_at;
+                const auto found = mIndex.find(aTableId);
+                return found == mIndex.end() ? nullptr : found->second;
             }
 
         inline const ChartData& operator[](std::string aTableId) const
             {
-                auto c = std::lower_bound(begin(), end(), aTableId, [](const auto& a, const auto& b) { return a.table_id() < b; });
-                if (c == end() || c->table_id() != aTableId)
-                    throw std::runtime_error("Tables::[]: table_id not found");
-                return *c;
+                if (const auto* found = find(aTableId); found)
+                    return *found;
+                throw std::runtime_error("Tables::[]: table_id not found");
             }
 
+     private:
+        std::vector<std::shared_ptr<ChartData>> mStorage;
+        Sorted mSorted;                                    // by table_id
+        std::unordered_map<std::string, ChartData*> mIndex; // table_id -> table
+
     }; // class Tables
 
+// ----------------------------------------------------------------------
+
+      // titer of an antigen against a serum in one table
+    struct TiterRef
+    {
+        const ChartData* table;
+        size_t antigen_no;
+        size_t serum_no;
+
+        inline std::string titer() const { return table->titer(antigen_no, serum_no); }
+        inline TiterMatrix::Code code() const { return table->titers().code(antigen_no, serum_no); }
+    };
+
+      // titers of an antigen against a serum (as named in tables) split by assay: HI and neutralisation (FR, PRN)
+    struct AssayTiters
+    {
+        const AntigenData* antigen;
+        ChartData::AgSrRef serum;
+        std::vector<TiterRef> hi;
+        std::vector<TiterRef> neut;
+
+        inline std::string serum_full_name() const { return serum.first + " " + serum.second; }
+    };
+
 // ----------------------------------------------------------------------
 
     class AntigenRefs : public std::vector<const AntigenData*>
@@ -226,6 +377,38 @@ namespace hidb
 
     }; // class AntigenRefs
 
+// ----------------------------------------------------------------------
+
+      // Scratch storage of finders taking it (e.g. HiDb::find_antigens(name, context)), reused
+      // between queries made by one thread: containers and strings are cleared but keep their
+      // capacity, so that a steady state query loop does not allocate for intermediate results.
+      // Results returned by reference are valid until the next query using the same context.
+    class QueryContext
+    {
+     public:
+        inline QueryContext() = default;
+        QueryContext(const QueryContext&) = delete;
+        QueryContext& operator=(const QueryContext&) = delete;
+
+          // antigens with the name looked up (find_by_index or all_by_index result), suggestions if antigen is not found
+        inline const AntigenRefs& antigens() const { return mAntigens; }
+
+          // used by finders without context, their results are copied out before returning
+        static inline QueryContext& this_thread() { static thread_local QueryContext sContext; return sContext; }
+
+     private:
+        using SplitName = std::array<std::string, 7>; // virus_type, host, location, isolation, year, passage, index_key
+
+        AntigenRefs mAntigens;
+        std::vector<const AntigenData*> mResult;
+        std::vector<AntigenSerumMatchScore<AntigenData>> mScores;
+        SplitName mName, mEntry;  // fields of the name looked up and of the name compared with it
+
+        friend class Antigens;
+        friend class HiDb;
+
+    }; // class QueryContext
+
 // ----------------------------------------------------------------------
 
     class Antigens : public std::vector<AntigenData>
@@ -233,53 +416,85 @@ namespace hidb
      public:
         AntigenRefs all(const HiDb& aHiDb) const;
 
-        void make_index(const HiDb& aHiDb);
+          // name buckets, date index and full name prefix index refer to antigens by ordinal
+          // (index in this vector), they stay valid in a copy (see HiDb::next_version())
+        void make_index();
+          // after inserting antigens with sorted ordinals aInserted (ordinals after inserting): shifts ordinals
+          // in the indices and adds the inserted antigens, dates of aChanged (sorted, including aInserted) are re-indexed
+        void update_index(const std::vector<size_t>& aInserted, const std::vector<size_t>& aChanged);
+          // names (host, location, isolation, year) for quick rejection by find_by_index(), filter has room for aCapacity names
+        void make_name_filter(size_t aCapacity);
+        void add_to_name_filter(const AntigenData& aAntigen);
+        inline size_t name_filter_capacity() const { return mNameFilter.capacity(); }
+          // false if there is definitely no antigen with this name (location looked up in locdb), true if name cannot be parsed
+        bool may_contain_name(std::string name) const;
           // if location is not found and aNotFoundLocation is not nullptr, location name is copied there and not reported to std::cerr
-        AntigenRefs find_by_index(std::string name, std::string* aNotFoundLocation = nullptr) const;
+        inline AntigenRefs find_by_index(std::string name, std::string* aNotFoundLocation = nullptr) const { return find_by_index(name, QueryContext::this_thread(), aNotFoundLocation); }
+          // result is aContext.antigens()
+        const AntigenRefs& find_by_index(std::string name, QueryContext& aContext, std::string* aNotFoundLocation = nullptr) const;
         AntigenRefs find_by_cdcid(std::string cdcid) const;
+          // uses date index built by make_index, antigens without isolation date are not included, result is sorted by date
+        AntigenRefs date_range(const HiDb& aHiDb, std::string aBegin, std::string aEnd) const;
 
-        inline const AntigenRefs* all_by_index(std::string name) const
-            {
-                try {
-                    return for_key(index_key(name));
-                }
-                catch (NotFound&) {
-                    return nullptr;
-                }
-            }
+          // antigens having full name starting with prefix (e.g. name typed so far, cdc name without passage) in full name order,
+          // at most aLimit of them (0 means unlimited), uses prefix index built by make_index
+        std::vector<const AntigenData*> find_by_full_name_prefix(std::string prefix, size_t aLimit = 0) const;
+        inline std::vector<std::string> full_names_with_prefix(std::string prefix, size_t aLimit = 0) const { return mFullNameIndex.keys(prefix, aLimit); }
+
+          // antigens in the name bucket of the location of name, result is aContext.antigens()
+        const AntigenRefs& all_by_index(std::string name, QueryContext& aContext) const;
 
         inline void location_func(virus_name::location_func_t aLocationFunc) { mLocationFunc = aLocationFunc; }
         inline virus_name::location_func_t location_func() const { return mLocationFunc; }
 
      private:
         static constexpr const size_t IndexKeySize = 2;
-        std::map<std::string, AntigenRefs> mIndex;
+        std::map<std::string, std::vector<size_t>> mIndex;  // index key -> sorted ordinals
+        std::vector<std::pair<std::string, size_t>> mDateIndex; // isolation date -> ordinal, sorted by date and ordinal
+        PrefixIndex<size_t> mFullNameIndex;
         virus_name::location_func_t mLocationFunc = &virus_name::location;
+        BloomFilter mNameFilter;
+
+          // unrecognized names are ordinary in lookups, they are reported by return value. Names without '/'
+          // (e.g. cdc names) cannot be split, they are rejected without throwing in virus_name::split
+        static inline bool may_be_international_name(std::string_view name) { return name.find('/') != std::string_view::npos; }
 
-        class NotFound : public std::runtime_error { public: using std::runtime_error::runtime_error; };
+        inline bool split(std::string name, QueryContext::SplitName& aFields) const { return split(name, aFields[0], aFields[1], aFields[2], aFields[3], aFields[4], aFields[5], aFields[6]); }
 
-        inline void split(std::string name, std::string& virus_type, std::string& host, std::string& location, std::string& isolation, std::string& year, std::string& passage, std::string& index_key) const
+          // returns false if name cannot be split
+        inline bool split(std::string name, std::string& virus_type, std::string& host, std::string& location, std::string& isolation, std::string& year, std::string& passage, std::string& index_key) const
             {
+                if (!may_be_international_name(name))
+                    return false;
                 try {
                     virus_name::split(name, virus_type, host, location, isolation, year, passage);
-                    index_key = location.substr(0, IndexKeySize);
                 }
                 catch (virus_name::Unrecognized&) {
-                    throw NotFound{"cannot split " + name};
+                    return false;
                 }
+                index_key = location.substr(0, IndexKeySize);
+                return true;
+            }
+
+        static inline std::string name_key(std::string host, std::string location, std::string isolation, std::string year)
+            {
+                return host + '/' + location + '/' + isolation + '/' + year;
             }
 
-        inline std::string index_key(std::string name) const
+          // nullopt if location cannot be found in name
+        inline std::optional<std::string> index_key(std::string name) const
             {
                 try {
                     return mLocationFunc(name).substr(0, IndexKeySize);
                 }
                 catch (virus_name::Unrecognized&) {
-                    throw NotFound{"cannot find location in " + name};
+                    return std::nullopt;
                 }
             }
 
-        inline const AntigenRefs* for_key(std::string key) const
+        static inline bool is_cdc_name(std::string_view name) { return name.size() > 3 && name[2] == ' '; }
+
+        inline const std::vector<size_t>* for_key(std::string key) const
             {
                 auto p = mIndex.find(key);
                 return p != mIndex.end() ? &p->second : nullptr;
@@ -295,6 +510,54 @@ namespace hidb
     {
     }; // class Sera
 
+// ----------------------------------------------------------------------
+
+      // antigen (name, variant_id) -> sera having that antigen as homologous in at least one table
+      // sera by name and variant_id of their homologous antigen, sera are referred by ordinal
+      // (index in HiDb::sera()), i.e. the index stays valid in a copy of hidb (see
+      // HiDb::next_version()) and HiDb::add() just shifts ordinals past inserted sera
+    class HomologousSera
+    {
+     public:
+        void make(const Sera& aSera);
+        void insert(const OrdinalShift& aShift);
+        void add(size_t aSerumNo, const SerumData& aSerum, std::string aHomologousVariantId);
+          // sorted ordinals of sera
+        const std::vector<size_t>* find(std::string aAntigenName, std::string aAntigenVariantId) const;
+
+     private:
+        std::map<std::pair<std::string, std::string>, std::vector<size_t>> mIndex;
+
+    }; // class HomologousSera
+
+// ----------------------------------------------------------------------
+
+      // Antigens having isolation date by region (country, continent, empty
+      // string for all), sorted by date, see HiDb::location_date_index().
+      // Country and continent are taken from antigen stat records, i.e. locdb
+      // is not consulted if hidb file has stat.
+    class LocationDateIndex
+    {
+     public:
+        LocationDateIndex(const HiDb& aHiDb);
+
+          // aRegion: country or continent name as in locdb, empty for all; antigens isolated in [aBegin, aEnd), empty aBegin or aEnd means unlimited
+        AntigenRefs antigens(std::string aRegion, std::string aBegin, std::string aEnd) const;
+        size_t count(std::string aRegion, std::string aBegin, std::string aEnd) const;
+          // year-month (YYYYMM) -> number of antigens
+        std::map<std::string, size_t> count_by_month(std::string aRegion, std::string aBegin, std::string aEnd) const;
+        std::vector<std::string> regions() const;
+
+     private:
+        using Entries = std::vector<std::pair<std::string, const AntigenData*>>; // isolation date, antigen
+
+        const HiDb& mHiDb;
+        std::unordered_map<std::string, Entries> mRegions;
+
+        std::pair<Entries::const_iterator, Entries::const_iterator> find(std::string aRegion, std::string aBegin, std::string aEnd) const;
+
+    }; // class LocationDateIndex
+
 // ----------------------------------------------------------------------
 
     using VirusType = std::string;
@@ -307,6 +570,37 @@ namespace hidb
     {
      public:
         void compute_totals();
+        void add(const HiDbStat& aNother); // sums counts, e.g. stat of several hidbs
+    };
+
+// ----------------------------------------------------------------------
+
+      // result of HiDb::lookup_antigen_exactly() and lookup_antigen_of_chart(), found is nullptr if
+      // antigen is not in hidb, suggestions are antigens with the same name then (as in HiDb::NotFound),
+      // unless bloom filter already tells that antigen is not in hidb (suggestions are empty then)
+    struct AntigenLookup
+    {
+        const AntigenData* found = nullptr;
+        AntigenRefs suggestions;
+
+        inline explicit operator bool() const { return found != nullptr; }
+    };
+
+// ----------------------------------------------------------------------
+
+      // Changes between two hidbs (see HiDb::diff()): tables are matched by
+      // table_id, antigens and sera by name_for_exact_matching(), matched
+      // entries are compared by content hash. Lists are sorted.
+    struct HiDbDiff
+    {
+        struct Changes
+        {
+            std::vector<std::string> added, removed, changed;
+            inline bool empty() const { return added.empty() && removed.empty() && changed.empty(); }
+        };
+
+        Changes tables, antigens, sera;
+        inline bool empty() const { return tables.empty() && antigens.empty() && sera.empty(); }
     };
 
 // ----------------------------------------------------------------------
@@ -326,10 +620,22 @@ namespace hidb
         };
 
         inline HiDb() {}
-
-        void add(const Chart& aChart);
+        HiDb(const HiDb&) = delete; // vaccine and location date indices point into the source, use next_version()
+        HiDb& operator=(const HiDb&) = delete;
+
+          // copy to be modified by add() while this one is still in use. Tables are shared, antigens, sera,
+          // ordinal based indices, bitmaps, filters and stat records are copied (nothing is rebuilt), yet it
+          // is O(size of hidb) in time and memory regardless of the number of charts added to the copy.
+          // Vaccine and location date indices are not copied, they are made again on request.
+        std::shared_ptr<HiDb> next_version() const;
+
+          // indices are updated once after all charts are added, add several charts in one call rather than one by one
+        void add(const std::vector<const Chart*>& aCharts);
+        inline void add(const Chart& aChart) { add(std::vector<const Chart*>{&aChart}); }
         void importFrom(std::string aFilename, report_time timer = report_time::No);
         void exportTo(std::string aFilename, bool aPretty, report_time timer = report_time::No) const;
+          // what aNewer added, removed and changed relative to this, tables shared with aNewer (see next_version()) are not compared
+        HiDbDiff diff(const HiDb& aNewer) const;
 
         inline const Antigens& antigens() const { return mAntigens; }
         inline Antigens& antigens() { return mAntigens; }
@@ -339,47 +645,207 @@ namespace hidb
         inline Tables& charts() { return mCharts; }
         inline const ChartData& table(std::string table_id) const { return charts()[table_id]; }
 
-        std::vector<const AntigenData*> find_antigens(std::string name_reassortant_annotations_passage) const;
-        const AntigenData& find_antigen_exactly(std::string name_reassortant_annotations_passage) const; // throws NotFound if antigen with this very set of data not found
-        std::vector<const AntigenData*> find_antigens_fuzzy(std::string name_reassortant_annotations_passage) const;
+          // labs of all tables, lab_mask() returns 0 for lab not in hidb and for labs not fitting into the mask
+        inline const std::vector<std::string>& labs() const { return mLabs; }
+        inline size_t lab_no(std::string aLab) const { return static_cast<size_t>(std::find(mLabs.begin(), mLabs.end(), aLab) - mLabs.begin()); }
+        inline LabMask lab_mask(std::string aLab) const { const auto no = lab_no(aLab); return no < LabMaskBits ? LabMask{1} << no : LabMask{0}; }
+
+        inline std::vector<const AntigenData*> find_antigens(std::string name_reassortant_annotations_passage) const { return find_antigens(name_reassortant_annotations_passage, QueryContext::this_thread()); }
+          // the same as the finders above using scratch storage of aContext, result is valid until the next query with aContext
+        const std::vector<const AntigenData*>& find_antigens(std::string name_reassortant_annotations_passage, QueryContext& aContext) const;
+        const std::vector<const AntigenData*>& find_antigens_fuzzy(std::string name_reassortant_annotations_passage, QueryContext& aContext) const;
+        const AntigenData* lookup_antigen_exactly(std::string name_reassortant_annotations_passage, QueryContext& aContext) const; // nullptr if not found, suggestions are in aContext.antigens() (empty if rejected by bloom filter)
+        inline const AntigenData& find_antigen_exactly(std::string name_reassortant_annotations_passage) const // throws NotFound if antigen with this very set of data not found
+            {
+                if (auto lookup = lookup_antigen_exactly(name_reassortant_annotations_passage); lookup)
+                    return *lookup.found;
+                else
+                    throw NotFound(name_reassortant_annotations_passage, lookup.suggestions);
+            }
+        inline std::vector<const AntigenData*> find_antigens_fuzzy(std::string name_reassortant_annotations_passage) const { return find_antigens_fuzzy(name_reassortant_annotations_passage, QueryContext::this_thread()); }
+          // autocomplete: full names of antigens starting with prefix in order, at most aLimit of them (0 means unlimited)
+        inline std::vector<std::string> complete_antigen_full_name(std::string prefix, size_t aLimit = 0) const { return mAntigens.full_names_with_prefix(prefix, aLimit); }
+        inline std::vector<const AntigenData*> find_antigens_by_full_name_prefix(std::string prefix, size_t aLimit = 0) const { return mAntigens.find_by_full_name_prefix(prefix, aLimit); }
         std::vector<const AntigenData*> find_antigens_extra_fuzzy(std::string name_reassortant_annotations_passage) const;
         inline std::vector<const AntigenData*> find_antigens_by_name(std::string name, std::string* aNotFoundLocation = nullptr) const { return mAntigens.find_by_index(name, aNotFoundLocation); }
         inline std::vector<const AntigenData*> find_antigens_by_cdcid(std::string cdcid) const  { return mAntigens.find_by_cdcid(cdcid); }
-        const AntigenData& find_antigen_of_chart(const Antigen& aAntigen) const; // throws if not found
+        inline const AntigenData& find_antigen_of_chart(const Antigen& aAntigen) const // throws NotFound if not found
+            {
+                if (auto lookup = lookup_antigen_of_chart(aAntigen); lookup)
+                    return *lookup.found;
+                else
+                    throw NotFound(aAntigen.full_name(), lookup.suggestions);
+            }
+          // the same as find_antigen_exactly() and find_antigen_of_chart() but not found is reported by the result instead of
+          // throwing, for lookups where misses are ordinary (e.g. annotating charts with many antigens not in hidb)
+        inline AntigenLookup lookup_antigen_exactly(std::string name_reassortant_annotations_passage) const
+            {
+                auto& context = QueryContext::this_thread();
+                return {lookup_antigen_exactly(name_reassortant_annotations_passage, context), context.antigens()};
+            }
+        AntigenLookup lookup_antigen_of_chart(const Antigen& aAntigen) const;
+          // false if antigen/serum definitely is not in hidb, probes bloom filters without looking up
+        inline bool may_contain_antigen(std::string name_reassortant_annotations_passage) const { return mAntigenFilter.may_contain(name_reassortant_annotations_passage); }
+        inline bool may_contain_antigen_name(std::string name) const { return mAntigens.may_contain_name(name); }
+        inline bool may_contain_serum(std::string name_reassortant_annotations_serum_id) const { return mSerumFilter.may_contain(name_reassortant_annotations_serum_id); }
 
         std::vector<std::pair<const AntigenData*, size_t>> find_antigens_with_score(std::string name) const;
         std::vector<std::string> list_antigen_names(std::string aLab, std::string aLineage, bool aFullName) const;
         std::vector<const AntigenData*> list_antigens(std::string aLab, std::string aLineage, std::string aAssay) const;
         std::vector<const SerumData*> find_sera(std::string name) const;
-        const SerumData& find_serum_exactly(std::string name_reassortant_annotations_serum_id) const; // throws NotFound if serum with this very set of data not found
+        inline const SerumData& find_serum_exactly(std::string name_reassortant_annotations_serum_id) const // throws NotFound if serum with this very set of data not found
+            {
+                if (const auto* found = lookup_serum_exactly(name_reassortant_annotations_serum_id); found)
+                    return *found;
+                throw NotFound(name_reassortant_annotations_serum_id);
+            }
+          // returns nullptr if not found
+        const SerumData* lookup_serum_exactly(std::string name_reassortant_annotations_serum_id) const;
         std::vector<std::pair<const SerumData*, size_t>> find_sera_with_score(std::string name) const;
         std::vector<std::string> list_serum_names(std::string aLab, std::string aLineage, bool aFullName) const;
         std::vector<const SerumData*> list_sera(std::string aLab, std::string aLineage) const;
+
+          // bitmap filters over antigen/serum ordinals, e.g. antigens_of(antigen_bitmaps().get(BitmapIndex::Lab, "CDC") & ~antigen_bitmaps().get(BitmapIndex::Assay, "HI"))
+        inline const BitmapIndex& antigen_bitmaps() const { return mAntigenBitmaps; }
+        inline const BitmapIndex& serum_bitmaps() const { return mSerumBitmaps; }
+        std::vector<const AntigenData*> antigens_of(const Bitmap& aSelected) const;
+        std::vector<const SerumData*> sera_of(const Bitmap& aSelected) const;
+
         std::vector<const SerumData*> find_homologous_sera(const AntigenData& aAntigen) const;
-        const SerumData& find_serum_of_chart(const Serum& aSerum, bool report_if_not_found = false) const; // throws if not found
+        const SerumData& find_serum_of_chart(const Serum& aSerum, bool report_if_not_found = false) const; // throws NotFound if not found
+        inline const SerumData* lookup_serum_of_chart(const Serum& aSerum) const { return lookup_serum_exactly(aSerum.full_name()); } // returns nullptr if not found
+          // titers of antigen against serum in all tables having both of them, ordered by table_id
+        std::vector<TiterRef> titers_for(const AntigenData& aAntigen, const SerumData& aSerum) const;
+          // for antigens found in both HI and neut assays (of aLab, if not empty): titers against every serum titrated
+          // with the antigen in both assays (in tables of aLab), grouped by antigen and serum
+        std::vector<AssayTiters> hi_vs_neut_titers(std::string aLab) const;
+          // GMT, fold drop vs homologous and "<" counts per row/column of the tables with the passed ids (all tables if aTableIds is empty) and pooled across them,
+          // a table listed more than once is counted once, throws NotFound naming a table_id not in hidb
+        TiterStatistics titer_statistics(const std::vector<std::string>& aTableIds) const;
         void find_homologous_antigens_for_sera_of_chart(Chart& aChart) const;
+          // isolation date of the first antigen with the same name as the serum, empty if there is none
         std::string serum_date(const SerumData& aSerum) const;
+          // made on the first call and kept until add(), see vaccines.hh; add() drops its reference,
+          // a caller keeps the index (and entries found in it) alive by holding the returned pointer
+        std::shared_ptr<const VaccineIndex> vaccine_index() const;
 
           // name is just (international) name without reassortant/passage
 
         inline AntigenRefs all_antigens() const { return mAntigens.all(*this); }
+          // antigens isolated in [aBegin, aEnd), empty aBegin or aEnd means unlimited
+        inline AntigenRefs antigens_by_date_range(std::string aBegin, std::string aEnd) const { return mAntigens.date_range(*this, aBegin, aEnd); }
+          // made on the first call (using stat records, see prepare_stat()) and kept until add(), as vaccine_index()
+        std::shared_ptr<const LocationDateIndex> location_date_index() const;
+          // antigens isolated in a country or continent (empty for all) in [aBegin, aEnd), sorted by date
+        AntigenRefs antigens_by_location_date(std::string aRegion, std::string aBegin, std::string aEnd) const;
+
+          // used by import and export
+        inline StatRecords& antigen_stat_records() { return mAntigenStat; }
+        inline StatRecords& serum_stat_records() { return mSerumStat; }
+        inline const StatRecords& antigen_stat_records() const { return mAntigenStat; }
+        inline const StatRecords& serum_stat_records() const { return mSerumStat; }
+        inline StatCube& antigen_stat_cube() { return mAntigenCube; }
+        inline const StatCube& antigen_stat_cube() const { return mAntigenCube; }
+        inline bool stat_records_made() const { return mStatRecordsMade; }
+          // makes stat records if they are not made yet or updates them after add(), called by stat methods, thread safe, needs locdb
+        void prepare_stat() const;
 
         std::vector<std::string> all_countries() const;
         std::vector<std::string> unrecognized_locations() const;
         void stat_antigens(HiDbStat& aStat, std::string aStart, std::string aEnd) const;
         void stat_sera(HiDbStat& aStat, HiDbStat* aStatUnique, std::string aStart, std::string aEnd) const;
+          // number of antigens (one per name) or sera (one per name or, if aUnique, each serum) isolated in [aStart, aEnd) for each combination of values of aDimensions, see StatRecords::dimension()
+          // "lab", "assay" and "virus_type" are of the first table of a name, the name is not counted under its other labs/assays
+        std::map<GroupBy::Key, size_t> stat_antigens_by(const std::vector<std::string>& aDimensions, std::string aStart, std::string aEnd) const;
+        std::map<GroupBy::Key, size_t> stat_sera_by(const std::vector<std::string>& aDimensions, bool aUnique, std::string aStart, std::string aEnd) const;
+          // the same as stat_antigens_by() using stat cube, aFilter: dimension name -> accepted values
+        std::map<GroupBy::Key, size_t> stat_antigens_cube(const std::vector<std::string>& aDimensions, const std::map<std::string, std::vector<std::string>>& aFilter, std::string aStart, std::string aEnd) const;
 
      private:
         Antigens mAntigens;
         Sera mSera;
         Tables mCharts;
+        HomologousSera mHomologousSera;
+        std::vector<std::string> mLabs; // index is a bit number in LabMask
+        BitmapIndex mAntigenBitmaps;
+        BitmapIndex mSerumBitmaps;
+        BloomFilter mAntigenFilter; // name_for_exact_matching
+        BloomFilter mSerumFilter;   // name_for_exact_matching
+          // stat records are imported and exported with hidb, they need locdb and are made or
+          // updated on the first stat request: add() just notes names of added antigens and sera
+        mutable StatRecords mAntigenStat; // record per antigen name
+        mutable StatRecords mSerumStat;   // record per serum name, weight is the number of sera with that name
+        mutable StatCube mAntigenCube;    // made from mAntigenStat
+        mutable StatCube mSerumCube;      // made from mSerumStat, counts sera
+        mutable StatCube mSerumNameCube;  // made from mSerumStat, counts serum names
+        mutable std::atomic<bool> mStatRecordsMade{false}; // set when records are made and up to date, see prepare_stat()
+        mutable bool mStatRecordsOutdated = false;         // records are made but names added since then are to be updated
+        mutable std::set<std::string> mStatAddedAntigens;  // names of antigens added since records were made
+        mutable std::set<std::string> mStatAddedSera;      // names of sera added since records were made
+        mutable std::mutex mStatMutex;                     // serializes making stat records by concurrent readers
+        mutable std::shared_ptr<const VaccineIndex> mVaccineIndex; // accessed atomically
+        mutable std::shared_ptr<const LocationDateIndex> mLocationDateIndex; // accessed atomically
+
+          // antigens and sera inserted by add(), entries are moved while inserting, they are
+          // looked up by name and variant_id after all charts are added to update indices
+        struct Added
+        {
+            using Key = std::pair<std::string, std::string>; // name, variant_id
+            std::vector<Key> antigens;         // inserted
+            std::vector<Key> sera;             // inserted
+            std::vector<Key> changed_antigens; // inserted or updated
+            std::vector<Key> changed_sera;     // inserted or updated
+            std::vector<std::pair<Key, std::string>> homologous; // serum, homologous variant_id
+        };
 
-        void add_antigen(const Antigen& aAntigen, std::string aTableId);
-        void add_serum(const Serum& aSerum, std::string aTableId, const std::vector<Antigen>& aAntigens);
-        const AntigenData& find_antigen_in_suggestions(std::string aName, const AntigenRefs& aSuggestions) const;
+        void add_chart(const Chart& aChart, Added& aAdded);
+        void add_lab(std::string aLab);
+        void update_summaries();
+        void make_bitmaps();
+          // shifts bitmaps by inserted entries and sets bits of changed ones (ordinals are sorted)
+        void update_bitmaps(const std::vector<size_t>& aInsertedAntigens, const std::vector<size_t>& aChangedAntigens, const std::vector<size_t>& aInsertedSera, const std::vector<size_t>& aChangedSera);
+        void make_filters();
+          // adds inserted entries to filters, makes filters again if they are full
+        void update_filters(const std::vector<size_t>& aAntigenOrdinals, const std::vector<size_t>& aSerumOrdinals);
+        void make_stat_records() const;
+        void update_stat_records() const;
+        void set_serum_stat_weights();
+
+        void add_antigen(const Antigen& aAntigen, std::string aTableId, Added& aAdded);
+        void add_serum(const Serum& aSerum, std::string aTableId, const std::vector<Antigen>& aAntigens, Added& aAdded);
+          // name with known misspellings of old charts fixed, see lookup_antigen_of_chart()
+        static std::string fixed_name_of_chart(std::string aName); // empty if name has nothing to fix
 
     }; // class HiDb
 
+// ----------------------------------------------------------------------
+
+      // Readers take snapshot() and keep using it while they need, it is not
+      // affected by subsequent add(). add() makes the next version of hidb (see
+      // HiDb::next_version()), adds charts to it and publishes it by atomic
+      // pointer swap. Concurrent add() calls are serialized. Each add() copies
+      // hidb (see next_version()), add charts in batches.
+    class VersionedHiDb
+    {
+     public:
+        using Snapshot = std::shared_ptr<const HiDb>;
+
+        VersionedHiDb(std::shared_ptr<HiDb> aHiDb);
+
+        inline Snapshot snapshot() const { return std::atomic_load(&mCurrent); }
+        inline size_t version() const { return mVersion; }
+
+          // all charts are added to the same version
+        void add(const std::vector<const Chart*>& aCharts);
+        inline void add(const Chart& aChart) { add(std::vector<const Chart*>{&aChart}); }
+
+     private:
+        Snapshot mCurrent;
+        std::atomic<size_t> mVersion{0};
+        std::mutex mWriterMutex;
+
+    }; // class VersionedHiDb
+
     template <typename AS> inline std::string report(const std::vector<const AS*>& aAntigens, std::string aPrefix = "")
     {
         std::ostringstream out;
@@ -393,24 +859,54 @@ namespace hidb
 
     template <typename AS> void AntigenSerumData<AS>::labs(const HiDb& aHiDb, std::vector<std::string>& aLabs) const
     {
-        std::transform(per_table().begin(), per_table().end(), std::back_inserter(aLabs), [&aHiDb](const auto& pt) -> std::string { return aHiDb.charts()[pt.table_id()].chart_info().lab(); });
+        for (size_t lab_no = 0; lab_no < std::min(aHiDb.labs().size(), LabMaskBits); ++lab_no) {
+            if (mLabs & (LabMask{1} << lab_no))
+                aLabs.push_back(aHiDb.labs()[lab_no]);
+        }
+        if (aHiDb.labs().size() > LabMaskBits) {
+            for (const auto& pt: mTables) {
+                if (const auto lab = aHiDb.charts()[pt.table_id()].chart_info().lab(); aHiDb.lab_no(lab) >= LabMaskBits)
+                    aLabs.push_back(lab);
+            }
+        }
         std::sort(aLabs.begin(), aLabs.end());
         aLabs.erase(std::unique(aLabs.begin(), aLabs.end()), aLabs.end());
     }
 
     template <typename AS> bool AntigenSerumData<AS>::has_lab(const HiDb& aHiDb, std::string aLab) const
     {
-        return std::find_if(per_table().begin(), per_table().end(), [&aHiDb,&aLab](const auto& pt) -> bool { return aHiDb.charts()[pt.table_id()].chart_info().lab() == aLab; }) != per_table().end();
+        const auto lab_no = aHiDb.lab_no(aLab);
+        if (lab_no < LabMaskBits)
+            return mLabs & (LabMask{1} << lab_no);
+        else if (lab_no < aHiDb.labs().size())
+            return std::any_of(mTables.begin(), mTables.end(), [&aHiDb,&aLab](const auto& pt) { return aHiDb.charts()[pt.table_id()].chart_info().lab() == aLab; });
+        else
+            return false;
     }
 
-    template <typename AS> bool AntigenSerumData<AS>::in_hi_assay(const HiDb& aHiDb) const
+    template <typename AS> void AntigenSerumData<AS>::update_summary(const HiDb& aHiDb)
     {
-        return std::find_if(per_table().begin(), per_table().end(), [&aHiDb](const auto& pt) -> bool { return aHiDb.charts()[pt.table_id()].chart_info().assay() == "HI"; }) != per_table().end();
-    }
-
-    template <typename AS> bool AntigenSerumData<AS>::in_neut_assay(const HiDb& aHiDb) const
-    {
-        return std::find_if(per_table().begin(), per_table().end(), [&aHiDb](const auto& pt) -> bool { return aHiDb.charts()[pt.table_id()].chart_info().assay() != "HI"; }) != per_table().end();
+        mDate.clear();
+        mMostRecentTable = mOldestTable = 0;
+        mLabs = 0;
+        mAssays = 0;
+        for (uint32_t table_no = 0; table_no < mTables.size(); ++table_no) {
+            auto& pt = mTables[table_no];
+            if (mTables[mMostRecentTable] < pt)
+                mMostRecentTable = table_no;
+            if (pt < mTables[mOldestTable])
+                mOldestTable = table_no;
+            if (mDate < pt.date())
+                mDate = pt.date();
+            const auto& table = aHiDb.charts()[pt.table_id()];
+            if constexpr (std::is_same_v<AS, Antigen>)
+                pt.set_index_in_table(table.antigen_index_by_full_name(mData.name() + " " + variant_id(mData)));
+            else
+                pt.set_index_in_table(table.serum_index_by_full_name(mData.name() + " " + variant_id(mData)));
+            const auto& info = table.chart_info();
+            mLabs |= aHiDb.lab_mask(info.lab());
+            mAssays |= info.assay() == "HI" ? AssayHI : AssayNeut;
+        }
     }
 
 // ----------------------------------------------------------------------
@@ -420,6 +916,20 @@ namespace hidb
     void setup(std::string aHiDbDir, std::optional<std::string> aLocDbFilename = {}, bool aVerbose = false);
     const HiDb& get(std::string aVirusType, report_time timer = report_time::No);
 
+      // found in hidb of virus_type: "A(H1N1)", "A(H3N2)" or "B"
+    template <typename Data> struct FoundIn
+    {
+        std::string virus_type;
+        const Data* data;
+    };
+
+      // query is run against H1, H3 and B hidbs concurrently (they are loaded concurrently if necessary), results are in that order
+    std::vector<FoundIn<AntigenData>> find_antigens_everywhere(std::string name_reassortant_annotations_passage, report_time timer = report_time::No);
+    std::vector<FoundIn<AntigenData>> find_antigen_exactly_everywhere(std::string name_reassortant_annotations_passage, report_time timer = report_time::No);
+    std::vector<FoundIn<AntigenData>> find_antigens_fuzzy_everywhere(std::string name_reassortant_annotations_passage, report_time timer = report_time::No);
+    std::vector<FoundIn<SerumData>> find_sera_everywhere(std::string name, report_time timer = report_time::No);
+    std::vector<FoundIn<SerumData>> find_serum_exactly_everywhere(std::string name_reassortant_annotations_serum_id, report_time timer = report_time::No);
+
 // ----------------------------------------------------------------------
 
 } // namespace hidb
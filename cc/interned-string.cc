@@ -0,0 +1,91 @@
+#include <unordered_map>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+
+#include "interned-string.hh"
+
+// ----------------------------------------------------------------------
+
+namespace
+{
+      // strings are looked up by string_view, i.e. without making std::string, lookups take shared lock
+    struct Pool
+    {
+        std::shared_mutex access;
+        std::deque<std::string> strings; // elements are not moved when appended
+        std::unordered_map<std::string_view, const std::string*> index; // view of pooled string -> it
+
+        inline const std::string* find(std::string_view aSource) const
+            {
+                const auto found = index.find(aSource);
+                return found == index.end() ? nullptr : found->second;
+            }
+    };
+
+    inline Pool& pool()
+    {
+        static Pool sPool;
+        return sPool;
+    }
+
+} // namespace
+
+// ----------------------------------------------------------------------
+
+const std::string& hidb::InternedString::empty_string()
+{
+    static const std::string sEmpty;
+    return sEmpty;
+
+} // hidb::InternedString::empty_string
+
+// ----------------------------------------------------------------------
+
+const std::string* hidb::InternedString::intern(std::string_view aSource)
+{
+    if (aSource.empty())
+        return &empty_string();
+    auto& the_pool = pool();
+    {
+        std::shared_lock<std::shared_mutex> lock{the_pool.access};
+        if (const auto* found = the_pool.find(aSource); found)
+            return found;
+    }
+    std::unique_lock<std::shared_mutex> lock{the_pool.access};
+    if (const auto* found = the_pool.find(aSource); found) // interned by another thread meanwhile
+        return found;
+    const auto& pooled = the_pool.strings.emplace_back(aSource);
+    the_pool.index.emplace(pooled, &pooled);
+    return &pooled;
+
+} // hidb::InternedString::intern
+
+// ----------------------------------------------------------------------
+
+std::optional<hidb::InternedString> hidb::InternedString::existing(std::string_view aSource)
+{
+    if (aSource.empty())
+        return InternedString{};
+    auto& the_pool = pool();
+    std::shared_lock<std::shared_mutex> lock{the_pool.access};
+    if (const auto* found = the_pool.find(aSource); found)
+        return InternedString{found};
+    return std::nullopt;
+
+} // hidb::InternedString::existing
+
+// ----------------------------------------------------------------------
+
+size_t hidb::InternedString::pool_size()
+{
+    auto& the_pool = pool();
+    std::shared_lock<std::shared_mutex> lock{the_pool.access};
+    return the_pool.strings.size();
+
+} // hidb::InternedString::pool_size
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
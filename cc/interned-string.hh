@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <iostream>
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+      // String stored once per process, equal strings share the same pooled
+      // copy, so InternedString is a pointer and its equality is a pointer
+      // compare. Used for per table fields (table id, date, lab id, variant id)
+      // that have few distinct values repeated in every antigen and serum. It is
+      // not a per hidb dictionary: a field is an 8 byte pointer rather than a small
+      // code, and strings of hidbs no longer used stay in the pool (it never
+      // shrinks). Pooled strings are not moved and can be read without locking.
+      // Pool is shared by all hidbs of the process (H1, H3 and B hidbs have the
+      // same dates and lab id prefixes), so that InternedString is just a pointer.
+      // Interning and existing() take the pool lock, loops comparing many
+      // fields with the same value intern it once before the loop.
+    class InternedString
+    {
+     public:
+        inline InternedString() : mString(&empty_string()) {}
+        inline InternedString(std::string_view aSource) : mString(intern(aSource)) {}
+        inline InternedString(const std::string& aSource) : mString(intern(aSource)) {}
+        inline InternedString(const char* aSource) : mString(intern(aSource)) {}
+
+        inline const std::string& str() const { return *mString; }
+        inline operator const std::string&() const { return *mString; }
+        inline operator std::string_view() const { return *mString; }
+        inline bool empty() const { return mString->empty(); }
+        inline size_t size() const { return mString->size(); }
+
+        inline bool operator == (const InternedString& aNother) const { return mString == aNother.mString; }
+        inline bool operator != (const InternedString& aNother) const { return mString != aNother.mString; }
+        inline bool operator < (const InternedString& aNother) const { return mString != aNother.mString && *mString < *aNother.mString; }
+
+          // pooled string equal to aSource without adding it to the pool, used for lookups, does not allocate
+        static std::optional<InternedString> existing(std::string_view aSource);
+          // number of distinct strings in the pool
+        static size_t pool_size();
+
+     private:
+        const std::string* mString;
+
+        inline explicit InternedString(const std::string* aPooled) : mString(aPooled) {}
+
+        static const std::string* intern(std::string_view aSource);
+        static const std::string& empty_string();
+
+    }; // class InternedString
+
+    inline std::ostream& operator << (std::ostream& out, const InternedString& aString) { return out << aString.str(); }
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -15,7 +15,7 @@ enum class JsonKey : char
     DrawingOrder='d', ErrorLinePositive='E', ErrorLineNegative='e', Grid='g', PointIndex='p', PointStyles='P', ProcrustesIndex='l', ProcrustesStyle='L', ShownOnAll='s', Title='t',
     ColumnBases='C',
       // HiDb
-    Tables='t', TableId='T', PerTable='T',
+    Tables='t', TableId='T', PerTable='T', Stat='S', StatCube='c',
 };
 
 // ----------------------------------------------------------------------
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+      // Sorted front-coded array of string keys with values, supports enumeration
+      // of keys having the given prefix. Keys are grouped in buckets, the first key
+      // of a bucket is stored in full, the other ones as the length of the prefix
+      // shared with the previous key and the rest. Lookup is a binary search among
+      // bucket heads followed by decoding keys of one or two buckets.
+    template <typename Value> class PrefixIndex
+    {
+     public:
+        using Entries = std::vector<std::pair<std::string, Value>>;
+
+          // entries with the same key are ordered by value
+        void make(Entries&& aEntries)
+            {
+                std::sort(aEntries.begin(), aEntries.end());
+                mData.clear();
+                mBuckets.clear();
+                mValues.clear();
+                mValues.reserve(aEntries.size());
+                std::string_view previous;
+                for (const auto& [key, value]: aEntries) {
+                    append(key, value, previous);
+                    previous = key;
+                }
+            }
+
+          // adds aAdded to the index, values of the entries already there are replaced with aValueMap(value)
+          // (e.g. ordinals shifted by inserting), the result is the same as make() of all entries. Existing
+          // keys are decoded in order and merged with the sorted added ones, they are not sorted again.
+        template <typename ValueMap> void insert(Entries&& aAdded, ValueMap aValueMap)
+            {
+                std::sort(aAdded.begin(), aAdded.end());
+                PrefixIndex merged;
+                merged.mValues.reserve(size() + aAdded.size());
+                std::string previous;
+                auto added = aAdded.begin();
+                auto append_added_before = [&](const std::string& aKey, const Value& aValue) {
+                    for (; added != aAdded.end() && (added->first < aKey || (added->first == aKey && added->second < aValue)); ++added) {
+                        merged.append(added->first, added->second, previous);
+                        previous = added->first;
+                    }
+                };
+                for_each({}, [&](const std::string& aKey, const Value& aValue) {
+                    const auto value = aValueMap(aValue);
+                    append_added_before(aKey, value);
+                    merged.append(aKey, value, previous);
+                    previous = aKey;
+                    return true;
+                });
+                for (; added != aAdded.end(); ++added) {
+                    merged.append(added->first, added->second, previous);
+                    previous = added->first;
+                }
+                *this = std::move(merged);
+            }
+
+        inline size_t size() const { return mValues.size(); }
+        inline bool empty() const { return mValues.empty(); }
+
+          // calls aFunc(const std::string& key, const Value& value) for keys starting with aPrefix in key order,
+          // stops when aFunc returns false
+        template <typename Func> void for_each(std::string_view aPrefix, Func aFunc) const
+            {
+                if (mBuckets.empty())
+                    return;
+                  // the first bucket with head >= aPrefix, keys having aPrefix may start in the bucket before it
+                const auto bucket = std::partition_point(mBuckets.begin(), mBuckets.end(), [this, aPrefix](uint32_t aOffset) { return head(aOffset) < aPrefix; });
+                size_t entry_no = static_cast<size_t>(bucket == mBuckets.begin() ? 0 : (bucket - mBuckets.begin() - 1)) * BucketSize;
+                size_t offset = mBuckets[entry_no / BucketSize];
+                std::string key;
+                for (; entry_no < mValues.size(); ++entry_no) {
+                    const size_t shared = get_length(offset), rest = get_length(offset);
+                    key.resize(shared);
+                    key.append(mData, offset, rest);
+                    offset += rest;
+                    if (key.compare(0, aPrefix.size(), aPrefix) == 0) {
+                        if (!aFunc(key, mValues[entry_no]))
+                            break;
+                    }
+                    else if (std::string_view(key) > aPrefix)
+                        break;
+                }
+            }
+
+          // values of keys starting with aPrefix in key order, at most aLimit of them (0 means unlimited)
+        inline std::vector<Value> find(std::string_view aPrefix, size_t aLimit = 0) const
+            {
+                std::vector<Value> result;
+                for_each(aPrefix, [&result, aLimit](const std::string&, const Value& aValue) { result.push_back(aValue); return aLimit == 0 || result.size() < aLimit; });
+                return result;
+            }
+
+          // distinct keys starting with aPrefix in order, at most aLimit of them (0 means unlimited)
+        inline std::vector<std::string> keys(std::string_view aPrefix, size_t aLimit = 0) const
+            {
+                std::vector<std::string> result;
+                for_each(aPrefix, [&result, aLimit](const std::string& aKey, const Value&) {
+                    if (result.empty() || result.back() != aKey)
+                        result.push_back(aKey);
+                    return aLimit == 0 || result.size() < aLimit;
+                });
+                return result;
+            }
+
+     private:
+        static constexpr const size_t BucketSize = 16;
+
+        std::string mData;              // per key: shared prefix length, rest length (both as varint), rest
+        std::vector<uint32_t> mBuckets; // offset in mData of the first key of each bucket
+        std::vector<Value> mValues;
+
+        inline void append(std::string_view aKey, const Value& aValue, std::string_view aPrevious)
+            {
+                size_t shared = 0;
+                if (mValues.size() % BucketSize == 0)
+                    mBuckets.push_back(static_cast<uint32_t>(mData.size()));
+                else
+                    shared = static_cast<size_t>(std::mismatch(aKey.begin(), aKey.begin() + static_cast<std::ptrdiff_t>(std::min(aKey.size(), aPrevious.size())), aPrevious.begin()).first - aKey.begin());
+                put_length(shared);
+                put_length(aKey.size() - shared);
+                mData.append(aKey.substr(shared));
+                mValues.push_back(aValue);
+            }
+
+        inline void put_length(size_t aLength)
+            {
+                for (; aLength >= 0x80; aLength >>= 7)
+                    mData.push_back(static_cast<char>((aLength & 0x7F) | 0x80));
+                mData.push_back(static_cast<char>(aLength));
+            }
+
+        inline size_t get_length(size_t& aOffset) const
+            {
+                size_t result = 0;
+                for (unsigned shift = 0; ; shift += 7) {
+                    const auto byte = static_cast<unsigned char>(mData[aOffset++]);
+                    result |= static_cast<size_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0)
+                        return result;
+                }
+            }
+
+          // the first key of a bucket is stored in full
+        inline std::string_view head(size_t aOffset) const
+            {
+                get_length(aOffset);
+                const size_t length = get_length(aOffset);
+                return std::string_view(mData).substr(aOffset, length);
+            }
+
+    }; // class PrefixIndex<>
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
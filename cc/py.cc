@@ -79,17 +79,18 @@ PYBIND11_MODULE(hidb_backend, m)
     m.def("vaccine_names", py::overload_cast<std::string, std::string>(&vaccine_names), py::arg("subtype"), py::arg("lineage") = "", py::return_value_policy::reference);
     m.def("vaccine_names", py::overload_cast<const Chart&>(&vaccine_names), py::arg("chart"), py::return_value_policy::reference);
     m.def("vaccines", py::overload_cast<const Chart&, bool>(&vaccines), py::arg("chart"), py::arg("verbose") = false); // -> VaccinesOfChart*
+    m.def("vaccines", py::overload_cast<const std::vector<const Chart*>&, bool>(&vaccines), py::arg("charts"), py::arg("verbose") = false, py::call_guard<py::gil_scoped_release>()); // -> [VaccinesOfChart]
 
       // ----------------------------------------------------------------------
       // HiDb
       // ----------------------------------------------------------------------
 
     py::class_<PerTable>(m, "PerTable")
-            .def("table_id", py::overload_cast<>(&PerTable::table_id, py::const_))
-            .def("date", py::overload_cast<>(&PerTable::date, py::const_))
-            .def("lab_id", py::overload_cast<>(&PerTable::lab_id, py::const_))
-            .def("has_lab_id", &PerTable::has_lab_id, py::arg("lab_id"))
-            .def("homologous", py::overload_cast<>(&PerTable::homologous, py::const_))
+            .def("table_id", &PerTable::table_id)
+            .def("date", &PerTable::date)
+            .def("lab_id", [](const PerTable& pt) { return std::vector<std::string>(pt.lab_id().begin(), pt.lab_id().end()); })
+            .def("has_lab_id", [](const PerTable& pt, std::string lab_id) { const auto interned = InternedString::existing(lab_id); return interned && pt.has_lab_id(*interned); }, py::arg("lab_id"))
+            .def("homologous", &PerTable::homologous)
             ;
 
     py::class_<AntigenData>(m, "AntigenData")
@@ -125,6 +126,20 @@ PYBIND11_MODULE(hidb_backend, m)
             .def("date_range", &AntigenRefs::date_range, py::arg("begin") = "", py::arg("end") = "")
             ;
 
+    py::class_<Bitmap>(m, "Bitmap")
+            .def("__len__", &Bitmap::size)
+            .def("count", &Bitmap::count)
+            .def("__and__", [](const Bitmap& a, const Bitmap& b) { return a & b; })
+            .def("__or__", [](const Bitmap& a, const Bitmap& b) { return a | b; })
+            .def("__invert__", [](const Bitmap& a) { return ~a; })
+            ;
+
+    py::class_<BitmapIndex>(m, "BitmapIndex")
+            .def("all", &BitmapIndex::all)
+            .def("get", [](const BitmapIndex& aIndex, std::string aDimension, std::string aValue) { return aIndex.get(BitmapIndex::dimension(aDimension), aValue); }, py::arg("dimension"), py::arg("value"), py::doc("dimension: \"lab\", \"lineage\", \"assay\", \"virus_type\", \"passage_type\", \"year\""))
+            .def("values", [](const BitmapIndex& aIndex, std::string aDimension) { return aIndex.values(BitmapIndex::dimension(aDimension)); }, py::arg("dimension"))
+            ;
+
       // Already registered! py::class_<ChartInfo>(m, "ChartInfo")
 
     py::class_<ChartData>(m, "ChartData")
@@ -133,11 +148,69 @@ PYBIND11_MODULE(hidb_backend, m)
             .def("number_of_antigens", &ChartData::number_of_antigens)
             .def("number_of_sera", &ChartData::number_of_sera)
             .def("antigen_index_by_full_name", &ChartData::antigen_index_by_full_name, py::arg("full_name"))
+            .def("serum_index_by_full_name", &ChartData::serum_index_by_full_name, py::arg("full_name"))
             .def("antigen_full_name", &ChartData::antigen_full_name, py::arg("index"))
             .def("serum_full_name", &ChartData::serum_full_name, py::arg("index"))
             .def("titer", &ChartData::titer, py::arg("antigen_no"), py::arg("serum_no"))
             ;
 
+    py::class_<TiterRef>(m, "TiterRef")
+            .def("table", [](const TiterRef& aRef) -> const ChartData& { return *aRef.table; }, py::return_value_policy::reference)
+            .def_readonly("antigen_no", &TiterRef::antigen_no)
+            .def_readonly("serum_no", &TiterRef::serum_no)
+            .def("titer", &TiterRef::titer)
+            ;
+
+    auto titer_texts = [](const std::vector<TiterRef>& aTiters) {
+        std::vector<std::string> result;
+        std::transform(aTiters.begin(), aTiters.end(), std::back_inserter(result), [](const auto& e) { return e.titer(); });
+        return result;
+    };
+
+    py::class_<AssayTiters>(m, "AssayTiters")
+            .def("antigen", [](const AssayTiters& aTiters) -> const AntigenData& { return *aTiters.antigen; }, py::return_value_policy::reference)
+            .def("antigen_full_name", [](const AssayTiters& aTiters) { return aTiters.antigen->data().full_name(); })
+            .def("serum_full_name", &AssayTiters::serum_full_name)
+            .def("hi", [titer_texts](const AssayTiters& aTiters) { return titer_texts(aTiters.hi); })
+            .def("neut", [titer_texts](const AssayTiters& aTiters) { return titer_texts(aTiters.neut); })
+            ;
+
+    py::class_<TiterStat>(m, "TiterStat")
+            .def_readonly("titers", &TiterStat::titers)
+            .def_readonly("less_than", &TiterStat::less_than)
+            .def_readonly("fold_drops", &TiterStat::fold_drops)
+            .def("mean_logged", &TiterStat::mean_logged)
+            .def("gmt", &TiterStat::gmt)
+            .def("mean_fold_drop", &TiterStat::mean_fold_drop)
+            ;
+
+    py::class_<TableTiterStat>(m, "TableTiterStat")
+            .def("table", [](const TableTiterStat& aStat) -> const ChartData& { return *aStat.table; }, py::return_value_policy::reference)
+            .def_readonly("antigens", &TableTiterStat::antigens)
+            .def_readonly("sera", &TableTiterStat::sera)
+            ;
+
+    auto by_full_name = [](const std::map<TiterStatistics::AgSrRef, TiterStat>& aSource) {
+        std::map<std::string, TiterStat> result;
+        for (const auto& [ref, stat]: aSource)
+            result.emplace(ref.first + " " + ref.second, stat);
+        return result;
+    };
+
+    py::class_<TiterStatistics>(m, "TiterStatistics")
+            .def("tables", &TiterStatistics::tables, py::return_value_policy::reference_internal)
+            .def("antigens", [by_full_name](const TiterStatistics& aStat) { return by_full_name(aStat.antigens()); }, py::doc("pooled across tables, dict full_name -> TiterStat"))
+            .def("sera", [by_full_name](const TiterStatistics& aStat) { return by_full_name(aStat.sera()); }, py::doc("pooled across tables, dict full_name -> TiterStat"))
+            .def("total", &TiterStatistics::total, py::return_value_policy::reference_internal)
+            ;
+
+    auto group_by_dict = [](const std::map<GroupBy::Key, size_t>& aCounts) {
+        py::dict result;
+        for (const auto& [key, count]: aCounts)
+            result[py::tuple(py::cast(key))] = count;
+        return result;
+    };
+
       // --------------------------------------------------
       // lambdas below are to avoid python GC affecting data
 
@@ -151,10 +224,18 @@ PYBIND11_MODULE(hidb_backend, m)
         return pointer_to_copy_antigen(aHiDb.list_antigens(lab, lineage, assay));
     };
 
+    auto antigens_of = [&pointer_to_copy_antigen](const HiDb& aHiDb, const Bitmap& aSelected) -> std::vector<AntigenData> {
+        return pointer_to_copy_antigen(aHiDb.antigens_of(aSelected));
+    };
+
     auto find_antigens_by_name = [&pointer_to_copy_antigen](const HiDb& aHiDb, std::string name) -> std::vector<AntigenData> {
         return pointer_to_copy_antigen(aHiDb.find_antigens_by_name(name));
     };
 
+    auto find_antigens_by_full_name_prefix = [&pointer_to_copy_antigen](const HiDb& aHiDb, std::string prefix, size_t limit) -> std::vector<AntigenData> {
+        return pointer_to_copy_antigen(aHiDb.find_antigens_by_full_name_prefix(prefix, limit));
+    };
+
     auto find_antigens = [&pointer_to_copy_antigen](const HiDb& aHiDb, std::string name) -> std::vector<AntigenData> {
         return pointer_to_copy_antigen(aHiDb.find_antigens(name));
     };
@@ -188,6 +269,10 @@ PYBIND11_MODULE(hidb_backend, m)
                          return pointer_to_copy_serum(aHiDb.list_sera(lab, lineage));
     };
 
+    auto sera_of = [&pointer_to_copy_serum](const HiDb& aHiDb, const Bitmap& aSelected) {
+        return pointer_to_copy_serum(aHiDb.sera_of(aSelected));
+    };
+
     auto find_sera = [&pointer_to_copy_serum](const HiDb& aHiDb, std::string name) {
         return pointer_to_copy_serum(aHiDb.find_sera(name));
     };
@@ -213,8 +298,26 @@ PYBIND11_MODULE(hidb_backend, m)
 
       // --------------------------------------------------
 
+    py::class_<HiDbDiff::Changes>(m, "HiDbDiffChanges")
+            .def_readonly("added", &HiDbDiff::Changes::added)
+            .def_readonly("removed", &HiDbDiff::Changes::removed)
+            .def_readonly("changed", &HiDbDiff::Changes::changed)
+            .def("empty", &HiDbDiff::Changes::empty)
+            ;
+
+    py::class_<HiDbDiff>(m, "HiDbDiff")
+            .def_readonly("tables", &HiDbDiff::tables)
+            .def_readonly("antigens", &HiDbDiff::antigens)
+            .def_readonly("sera", &HiDbDiff::sera)
+            .def("empty", &HiDbDiff::empty)
+            ;
+
+      // --------------------------------------------------
+
     py::class_<HiDb>(m, "HiDb")
-            .def("add", &HiDb::add, py::arg("chart"))
+            .def("add", [](HiDb& aHiDb, const Chart& aChart) { aHiDb.add(aChart); }, py::arg("chart"))
+            .def("add_charts", [](HiDb& aHiDb, const std::vector<const Chart*>& aCharts) { aHiDb.add(aCharts); }, py::arg("charts"), py::doc("adds charts updating indices once, faster than adding them one by one"))
+            .def("diff", &HiDb::diff, py::arg("newer"), py::call_guard<py::gil_scoped_release>())
 
               // three functions below required by bin/hidb-update
             .def(py::init<>())
@@ -223,32 +326,67 @@ PYBIND11_MODULE(hidb_backend, m)
 
             .def("table", &HiDb::table, py::arg("table_id"), py::return_value_policy::reference)
             .def("all_antigens", &HiDb::all_antigens, py::return_value_policy::reference)
+            .def("antigens_by_date_range", &HiDb::antigens_by_date_range, py::arg("begin") = "", py::arg("end") = "", py::doc("antigens isolated in [begin, end) sorted by date, uses date index"))
+            .def("antigens_by_location_date", &HiDb::antigens_by_location_date, py::arg("region") = "", py::arg("begin") = "", py::arg("end") = "", py::doc("antigens isolated in country or continent in [begin, end) sorted by date, uses location date index"))
+            .def("count_antigens_by_location_date", [](const HiDb& aHiDb, std::string region, std::string begin, std::string end) { return aHiDb.location_date_index()->count(region, begin, end); }, py::arg("region") = "", py::arg("begin") = "", py::arg("end") = "")
+            .def("count_antigens_by_month", [](const HiDb& aHiDb, std::string region, std::string begin, std::string end) { return aHiDb.location_date_index()->count_by_month(region, begin, end); }, py::arg("region") = "", py::arg("begin") = "", py::arg("end") = "", py::doc("{YYYYMM: count}"))
+            .def("location_date_regions", [](const HiDb& aHiDb) { return aHiDb.location_date_index()->regions(); }, py::doc("countries and continents having antigens with isolation date"))
             .def("all_countries", &HiDb::all_countries)
             .def("unrecognized_locations", &HiDb::unrecognized_locations, py::doc("returns unrecognized locations found in all antigen/serum names"))
 
             .def("stat_antigens", &HiDb::stat_antigens, py::arg("stat"), py::arg("start_date") = "", py::arg("end_date") = "")
             .def("stat_sera", &HiDb::stat_sera, py::arg("stat"), py::arg("stat_unique"), py::arg("start_date") = "", py::arg("end_date") = "")
+            .def("stat_antigens_by", [group_by_dict](const HiDb& aHiDb, const std::vector<std::string>& aDimensions, std::string aStart, std::string aEnd) { return group_by_dict(aHiDb.stat_antigens_by(aDimensions, aStart, aEnd)); },
+                 py::arg("dimensions"), py::arg("start_date") = "", py::arg("end_date") = "", py::doc("dict (value per dimension) -> number of antigens, dimensions: virus_type, lineage, lab, year_month, continent, country, assay"))
+            .def("stat_sera_by", [group_by_dict](const HiDb& aHiDb, const std::vector<std::string>& aDimensions, bool aUnique, std::string aStart, std::string aEnd) { return group_by_dict(aHiDb.stat_sera_by(aDimensions, aUnique, aStart, aEnd)); },
+                 py::arg("dimensions"), py::arg("unique") = false, py::arg("start_date") = "", py::arg("end_date") = "", py::doc("dict (value per dimension) -> number of sera, dimensions: virus_type, lineage, lab, year_month, continent, country, assay"))
+            .def("stat_antigens_cube", [group_by_dict](const HiDb& aHiDb, const std::vector<std::string>& aDimensions, const std::map<std::string, std::vector<std::string>>& aFilter, std::string aStart, std::string aEnd) { return group_by_dict(aHiDb.stat_antigens_cube(aDimensions, aFilter, aStart, aEnd)); },
+                 py::arg("dimensions"), py::arg("filter") = std::map<std::string, std::vector<std::string>>{}, py::arg("start_date") = "", py::arg("end_date") = "", py::doc("as stat_antigens_by using precomputed cube, filter: {dimension: [accepted values]}"))
 
             .def("list_antigen_names", &HiDb::list_antigen_names, py::arg("lab") = "", py::arg("lineage") = "", py::arg("full_name") = false)
             .def("list_antigens", list_antigens, py::arg("lab"), py::arg("lineage") = "", py::arg("assay") = "", py::doc("assay: \"hi\", \"neut\", \"\""))
             .def("find_antigens", find_antigens, py::arg("name"))
+            .def("may_contain_antigen", &HiDb::may_contain_antigen, py::arg("name"), py::doc("False if antigen with this full name is definitely not in hidb (bloom filter)"))
+            .def("may_contain_antigen_name", &HiDb::may_contain_antigen_name, py::arg("name"), py::doc("False if antigen with this name (without passage etc.) is definitely not in hidb (bloom filter)"))
+            .def("may_contain_serum", &HiDb::may_contain_serum, py::arg("name"), py::doc("False if serum with this full name is definitely not in hidb (bloom filter)"))
             .def("find_antigens_fuzzy", find_antigens_fuzzy, py::arg("name"))
             .def("find_antigens_extra_fuzzy", find_antigens_extra_fuzzy, py::arg("name"))
             .def("find_antigens_with_score", find_antigens_with_score, py::arg("name"))
             .def("find_antigens_by_name", find_antigens_by_name, py::arg("name"), py::return_value_policy::reference)
             .def("find_antigens_by_cdcid", find_antigens_by_cdcid, py::arg("cdcid"))
+            .def("complete_antigen_full_name", &HiDb::complete_antigen_full_name, py::arg("prefix"), py::arg("limit") = 20, py::doc("full names of antigens starting with prefix in order (autocomplete), limit 0 means unlimited"))
+            .def("find_antigens_by_full_name_prefix", find_antigens_by_full_name_prefix, py::arg("prefix"), py::arg("limit") = 20)
             .def("list_serum_names", &HiDb::list_serum_names, py::arg("lab") = "", py::arg("lineage") = "", py::arg("full_name") = false)
             .def("list_sera", list_sera, py::arg("lab"), py::arg("lineage") = "")
             .def("find_sera", find_sera, py::arg("name"))
             .def("find_homologous_sera", find_homologous_sera, py::arg("antigen"))
             .def("find_sera_with_score", find_sera_with_score, py::arg("name"))
             .def("find_homologous_antigens_for_sera_of_chart", &HiDb::find_homologous_antigens_for_sera_of_chart, py::arg("chart"))
+            .def("hi_vs_neut_titers", &HiDb::hi_vs_neut_titers, py::arg("lab") = "", py::doc("titers of antigens found in both HI and neut assays grouped by antigen and serum"))
+            .def("titer_statistics", &HiDb::titer_statistics, py::arg("table_ids") = std::vector<std::string>{}, py::doc("GMT, fold drop vs homologous and \"<\" counts per row/column of tables (all if table_ids is empty) and pooled"))
+            .def("titers_for", &HiDb::titers_for, py::arg("antigen"), py::arg("serum"), py::doc("titers of antigen against serum in all tables having both of them"))
+            .def("antigen_bitmaps", &HiDb::antigen_bitmaps, py::return_value_policy::reference_internal)
+            .def("serum_bitmaps", &HiDb::serum_bitmaps, py::return_value_policy::reference_internal)
+            .def("antigens_of", antigens_of, py::arg("bitmap"))
+            .def("sera_of", sera_of, py::arg("bitmap"))
             ;
 
       // ----------------------------------------------------------------------
 
     m.def("hidb_setup", [](std::string hidb_dir, std::string locdb_filename, bool verbose) { hidb::setup(hidb_dir, locdb_filename, verbose); }, py::arg("hidb_dir"), py::arg("locdb_filename") = "", py::arg("verbose") = false);
-    m.def("get_hidb", [](std::string aVirusType, bool aTimer) { return hidb::get(aVirusType, aTimer ? report_time::Yes : report_time::No); }, py::arg("virus_type"), py::arg("timer") = false, py::return_value_policy::reference);
+    m.def("get_hidb", [](std::string aVirusType, bool aTimer) -> const HiDb& { return hidb::get(aVirusType, aTimer ? report_time::Yes : report_time::No); }, py::arg("virus_type"), py::arg("timer") = false, py::return_value_policy::reference);
+
+      // [(virus_type, data)]
+    auto found_in_to_copy = [](const auto& source) {
+        std::vector<std::pair<std::string, std::decay_t<decltype(*source.front().data)>>> result;
+        std::transform(source.begin(), source.end(), std::back_inserter(result), [](const auto& e) { return std::make_pair(e.virus_type, *e.data); });
+        return result;
+    };
+    m.def("find_antigens_everywhere", [found_in_to_copy](std::string name) { return found_in_to_copy(hidb::find_antigens_everywhere(name)); }, py::arg("name"), py::call_guard<py::gil_scoped_release>());
+    m.def("find_antigen_exactly_everywhere", [found_in_to_copy](std::string name) { return found_in_to_copy(hidb::find_antigen_exactly_everywhere(name)); }, py::arg("name"), py::call_guard<py::gil_scoped_release>());
+    m.def("find_antigens_fuzzy_everywhere", [found_in_to_copy](std::string name) { return found_in_to_copy(hidb::find_antigens_fuzzy_everywhere(name)); }, py::arg("name"), py::call_guard<py::gil_scoped_release>());
+    m.def("find_sera_everywhere", [found_in_to_copy](std::string name) { return found_in_to_copy(hidb::find_sera_everywhere(name)); }, py::arg("name"), py::call_guard<py::gil_scoped_release>());
+    m.def("find_serum_exactly_everywhere", [found_in_to_copy](std::string name) { return found_in_to_copy(hidb::find_serum_exactly_everywhere(name)); }, py::arg("name"), py::call_guard<py::gil_scoped_release>());
 
 }
 
@@ -0,0 +1,283 @@
+// Tests of hidb parts that do not need hidb, charts or locdb: prefix index,
+// bloom filter, interned strings, bitmaps, titer matrix and stat records.
+// Exit status is the number of failed checks (0 if all passed).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "prefix-index.hh"
+#include "bloom-filter.hh"
+#include "interned-string.hh"
+#include "hidb-bitmap.hh"
+#include "titers.hh"
+#include "hidb-stat.hh"
+
+using namespace hidb;
+
+// ----------------------------------------------------------------------
+
+static size_t sFailed = 0;
+
+static inline void check(bool aCondition, const char* aText, int aLine)
+{
+    if (!aCondition) {
+        std::cerr << "FAILED " << __FILE__ << ':' << aLine << ": " << aText << '\n';
+        ++sFailed;
+    }
+}
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+static void test_prefix_index();
+static void test_bloom_filter();
+static void test_interned_string();
+static void test_bitmap();
+static void test_titer_matrix();
+static void test_stat();
+
+// ----------------------------------------------------------------------
+
+int main()
+{
+    test_prefix_index();
+    test_bloom_filter();
+    test_interned_string();
+    test_bitmap();
+    test_titer_matrix();
+    test_stat();
+    if (sFailed)
+        std::cerr << sFailed << " checks FAILED\n";
+    return static_cast<int>(std::min(sFailed, size_t{125}));
+}
+
+// ----------------------------------------------------------------------
+
+void test_prefix_index()
+{
+    std::mt19937 generator{7};
+    std::uniform_int_distribution<int> letter{'A', 'D'}, length{0, 6};
+    PrefixIndex<size_t>::Entries entries;
+    for (size_t no = 0; no < 1000; ++no) {
+        std::string key;
+        for (int len = length(generator); len > 0; --len)
+            key.push_back(static_cast<char>(letter(generator)));
+        entries.emplace_back(key, no);
+    }
+    auto sorted = entries;
+    std::sort(sorted.begin(), sorted.end());
+
+      // every third entry is inserted into index made of the others, values of the others are doubled then
+    PrefixIndex<size_t>::Entries initial, inserted, all;
+    for (const auto& [key, value]: entries) {
+        (value % 3 ? initial : inserted).emplace_back(key, value % 3 ? value : value * 2);
+        all.emplace_back(key, value * 2);
+    }
+    PrefixIndex<size_t> updated, made;
+    updated.make(std::move(initial));
+    updated.insert(std::move(inserted), [](size_t value) { return value * 2; });
+    made.make(std::move(all));
+    CHECK(updated.size() == made.size());
+    CHECK(updated.keys("") == made.keys(""));
+    CHECK(updated.find("") == made.find(""));
+    CHECK(updated.find("CA") == made.find("CA"));
+
+    PrefixIndex<size_t> index;
+    CHECK(index.find("A").empty());
+    index.make(std::move(entries));
+    CHECK(index.size() == sorted.size());
+
+    for (std::string prefix: {"", "A", "AB", "DDD", "CAB", "ABCDA", "AAAAAAA", "E"}) {
+        std::vector<std::string> expected;
+        std::vector<size_t> expected_values;
+        for (const auto& [key, value]: sorted) {
+            if (key.compare(0, prefix.size(), prefix) == 0) {
+                if (expected.empty() || expected.back() != key)
+                    expected.push_back(key);
+                expected_values.push_back(value);
+            }
+        }
+        CHECK(index.keys(prefix) == expected);
+        auto found = index.find(prefix);
+        CHECK(found.size() == expected_values.size());
+        std::sort(found.begin(), found.end());
+        std::sort(expected_values.begin(), expected_values.end());
+        CHECK(found == expected_values);
+        CHECK(index.keys(prefix, 3).size() == std::min(expected.size(), size_t{3}));
+    }
+}
+
+// ----------------------------------------------------------------------
+
+void test_bloom_filter()
+{
+    CHECK(BloomFilter{}.may_contain("anything"));
+
+    BloomFilter filter(1000);
+    CHECK(filter.capacity() >= 1000 && filter.capacity() < 1100);
+    for (size_t no = 0; no < 1000; ++no)
+        filter.add("A(H3N2)/TEXAS/" + std::to_string(no) + "/2017");
+    bool all_found = true;
+    for (size_t no = 0; no < 1000; ++no)
+        all_found &= filter.may_contain("A(H3N2)/TEXAS/" + std::to_string(no) + "/2017");
+    CHECK(all_found);
+    size_t false_positives = 0;
+    for (size_t no = 0; no < 10000; ++no)
+        false_positives += filter.may_contain("B/TEXAS/" + std::to_string(no) + "/2017");
+    CHECK(false_positives < 300); // expected about 1%
+}
+
+// ----------------------------------------------------------------------
+
+void test_interned_string()
+{
+    const InternedString a{"CDC#2017123456"}, b{std::string("CDC#2017123456")}, c{"CDC#2017123457"};
+    CHECK(a == b);
+    CHECK(&a.str() == &b.str());
+    CHECK(a != c);
+    CHECK(a < c);
+    CHECK(!(a < b));
+    CHECK(InternedString{}.empty());
+    CHECK(InternedString{""} == InternedString{});
+    CHECK(a.str() == "CDC#2017123456");
+    const auto existing = InternedString::existing("CDC#2017123456");
+    CHECK(existing && *existing == a);
+    CHECK(!InternedString::existing("never interned in this test"));
+
+      // the same strings interned concurrently are pooled once
+    std::vector<std::vector<const std::string*>> pooled(4);
+    std::vector<std::thread> threads;
+    for (auto& of_thread: pooled) {
+        threads.emplace_back([&of_thread]() {
+            for (size_t no = 0; no < 1000; ++no)
+                of_thread.push_back(&InternedString{"interned concurrently " + std::to_string(no)}.str());
+        });
+    }
+    for (auto& thread: threads)
+        thread.join();
+    CHECK(std::all_of(pooled.begin(), pooled.end(), [&pooled](const auto& of_thread) { return of_thread == pooled.front(); }));
+}
+
+// ----------------------------------------------------------------------
+
+void test_bitmap()
+{
+    Bitmap even(130), all(130, true);
+    for (size_t no = 0; no < 130; no += 2)
+        even.set(no);
+    CHECK(even.count() == 65);
+    CHECK(all.count() == 130);
+    CHECK((~even).count() == 65);
+    CHECK((even & ~even).count() == 0);
+    CHECK((even | ~even).count() == 130);
+    std::vector<size_t> ordinals;
+    (~even).for_each([&ordinals](size_t aNo) { ordinals.push_back(aNo); });
+    CHECK(ordinals.size() == 65 && ordinals.front() == 1 && ordinals.back() == 129);
+    even.reset(0);
+    CHECK(!even.test(0) && even.count() == 64);
+
+      // old entries 0..3, entries inserted before 0, between 1 and 2 (two of them) and after 3
+    const OrdinalShift shift({0, 3, 4, 7});
+    CHECK(shift(0) == 1 && shift(1) == 2 && shift(2) == 5 && shift(3) == 6);
+    Bitmap odd(4);
+    odd.set(1);
+    odd.set(3);
+    const auto shifted = odd.shifted(shift);
+    ordinals.clear();
+    shifted.for_each([&ordinals](size_t aNo) { ordinals.push_back(aNo); });
+    CHECK(shifted.size() == 8 && (ordinals == std::vector<size_t>{2, 6}));
+}
+
+// ----------------------------------------------------------------------
+
+void test_titer_matrix()
+{
+    const std::vector<std::vector<std::string>> source{{"40", "<10", ">1280", "*"}, {"<20480", "040", "1:40", "163840"}};
+    const TiterMatrix titers(source);
+    CHECK(titers.number_of_antigens() == 2);
+    CHECK(titers.number_of_sera() == 4);
+    CHECK(titers.list() == source);
+    CHECK(TiterMatrix::dont_care(titers.code(0, 3)));
+    CHECK(TiterMatrix::qualifier(titers.code(0, 1)) == TiterMatrix::LessThan);
+    CHECK(TiterMatrix::qualifier(titers.code(0, 2)) == TiterMatrix::MoreThan);
+    CHECK(titers.value(titers.code(0, 0)) == 40.0);
+    CHECK(titers.logged(titers.code(0, 0)) == 2.0);
+    CHECK(titers.value(titers.code(1, 0)) == 20480.0); // too big to be encoded, kept as text
+    CHECK(titers.value(titers.code(1, 1)) == 40.0);
+    CHECK(titers.value(titers.code(1, 3)) == 163840.0);
+    CHECK(std::isnan(titers.logged(titers.code(0, 3))));
+      // special titers keep their qualifier
+    CHECK(TiterMatrix::qualifier(titers.code(1, 0)) == TiterMatrix::Special);
+    CHECK(titers.text_qualifier(titers.code(1, 0)) == TiterMatrix::LessThan);
+    CHECK(titers.text_qualifier(titers.code(1, 1)) == TiterMatrix::Special); // "040"
+    CHECK(titers.text_qualifier(titers.code(0, 1)) == TiterMatrix::LessThan);
+    CHECK(titers.text_qualifier(titers.code(0, 2)) == TiterMatrix::MoreThan);
+    CHECK(titers.text_qualifier(titers.code(0, 3)) == TiterMatrix::Special);
+    const TiterMatrix big(std::vector<std::vector<std::string>>{{">20480", "<040"}});
+    CHECK(big.text_qualifier(big.code(0, 0)) == TiterMatrix::MoreThan);
+    CHECK(big.text_qualifier(big.code(0, 1)) == TiterMatrix::LessThan);
+}
+
+// ----------------------------------------------------------------------
+
+void test_stat()
+{
+    StatRecords records;
+    auto values = [](std::string virus_type, std::string lab, std::string year_month) {
+        StatRecords::Values result;
+        result[StatRecords::VirusType] = virus_type;
+        result[StatRecords::Lab] = lab;
+        result[StatRecords::YearMonth] = year_month;
+        return result;
+    };
+    records.put("A", values("A(H3N2)", "CDC", "201701"), 1);
+    records.put("B", values("A(H3N2)", "CDC", "201702"), 2);
+    records.put("C", values("B", "NIMR", "201701"), 3);
+    records.put("D", values("A(H3N2)", "NIMR", ""), 4);
+    CHECK(records.size() == 4);
+    CHECK(records.find("C") == 2);
+    CHECK(records.find("E") == StatRecords::NotFound);
+    records.put("A", values("A(H3N2)", "NIMR", "201701"), 1); // replaced
+    CHECK(records.size() == 4);
+    CHECK(records.value(0, StatRecords::Lab) == "NIMR");
+
+    const auto by_lab = GroupBy(records, {StatRecords::Lab}, records.all()).counts();
+    CHECK((by_lab == std::map<GroupBy::Key, size_t>{{{"CDC"}, 1}, {{"NIMR"}, 3}}));
+    const auto by_lab_weighted = GroupBy(records, {StatRecords::Lab}, records.all(), true).counts();
+    CHECK((by_lab_weighted == std::map<GroupBy::Key, size_t>{{{"CDC"}, 2}, {{"NIMR"}, 8}}));
+    const auto h3 = records.select(StatRecords::VirusType, [](const std::string& value) { return value == "A(H3N2)"; });
+    const auto h3_by_month = GroupBy(records, {StatRecords::YearMonth, StatRecords::Lab}, h3).counts();
+    CHECK((h3_by_month == std::map<GroupBy::Key, size_t>{{{"", "NIMR"}, 1}, {{"201701", "NIMR"}, 1}, {{"201702", "CDC"}, 1}}));
+
+      // too many combinations for dense counters, hash table is used
+    StatRecords many;
+    std::map<GroupBy::Key, size_t> expected;
+    for (size_t no = 0; no < 20000; ++no) {
+        StatRecords::Values record_values;
+        record_values[StatRecords::VirusType] = std::to_string(no % 41);
+        record_values[StatRecords::Lab] = std::to_string(no % 43);
+        record_values[StatRecords::Country] = std::to_string(no % 47);
+        record_values[StatRecords::YearMonth] = std::to_string(no % 53);
+        many.put(std::to_string(no), record_values, no % 3);
+        expected[{record_values[StatRecords::VirusType], record_values[StatRecords::Lab], record_values[StatRecords::Country], record_values[StatRecords::YearMonth]}] += no % 3;
+    }
+    for (auto entry = expected.begin(); entry != expected.end(); )
+        entry = entry->second ? std::next(entry) : expected.erase(entry);
+    CHECK((GroupBy(many, {StatRecords::VirusType, StatRecords::Lab, StatRecords::Country, StatRecords::YearMonth}, many.all(), true).counts() == expected));
+
+    StatCube cube;
+    cube.make(records);
+    CHECK((cube.slice({StatRecords::Lab}, {}, "", "") == by_lab_weighted));
+    CHECK((cube.slice({StatRecords::VirusType}, {{StatRecords::Lab, {"NIMR"}}}, "2017-01", "2017-02") == std::map<GroupBy::Key, size_t>{{{"A(H3N2)"}, 1}, {{"B"}, 3}}));
+    cube.adjust(values("B", "NIMR", "201701"), -3);
+    CHECK((cube.slice({StatRecords::VirusType}, {}, "", "") == std::map<GroupBy::Key, size_t>{{{"A(H3N2)"}, 7}}));
+}
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
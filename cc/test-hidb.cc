@@ -0,0 +1,444 @@
+// Tests of hidb lookups, indices, stat and diff against hidb made by
+// bin/hidb-update from a chart (see test/test). The same checks are run
+// against hidb imported from the file, hidb made by HiDb::add() from the
+// chart and versions made by next_version() and VersionedHiDb, i.e. indices
+// rebuilt by add() are checked the same way as the imported ones.
+// Exit status is the number of failed checks (0 if all passed).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
+
+#include "acmacs-base/argc-argv.hh"
+#include "acmacs-base/read-file.hh"
+#include "acmacs-chart-1/ace.hh"
+#include "locationdb/locdb.hh"
+#include "hidb.hh"
+#include "vaccines.hh"
+
+using namespace std::string_literals;
+using namespace hidb;
+
+// ----------------------------------------------------------------------
+
+static size_t sFailed = 0;
+
+static inline void check(bool aCondition, const char* aText, int aLine, std::string aContext)
+{
+    if (!aCondition) {
+        std::cerr << "FAILED " << __FILE__ << ':' << aLine << ": " << aText << " [" << aContext << "]\n";
+        ++sFailed;
+    }
+}
+
+  // aContext (name of hidb tested, antigen name) is reported on failure
+#define CHECK(condition, context) check((condition), #condition, __LINE__, (context))
+
+  // pointer refers to an element of the vector, i.e. it is not left over from before insertion or copying
+template <typename AS> static inline bool belongs(const std::vector<AS>& aData, const AS* aEntry)
+{
+    return aEntry >= aData.data() && aEntry < aData.data() + aData.size();
+}
+
+static void test_lookups(const HiDb& aHiDb, std::string aWhat);
+static void test_query_context(const HiDb& aHiDb, std::string aWhat);
+static void test_date_range(const HiDb& aHiDb, std::string aWhat);
+static void test_prefix(const HiDb& aHiDb, std::string aWhat);
+static void test_bitmaps(const HiDb& aHiDb, std::string aWhat);
+static void test_stat(const HiDb& aHiDb, std::string aWhat);
+static void test_same_records(const StatRecords& aMade, const StatRecords& aUpdated, std::string aWhat);
+static void test_titer_stat(const HiDb& aHiDb, std::string aWhat);
+static void test_diff(const HiDb& aImported, const HiDb& aAdded);
+static void test_many_labs(std::string aChartFilename);
+
+constexpr const char* sUsage = " [options] <chart.acd1.xz> <hidb.json.xz made from that chart>\n";
+
+// ----------------------------------------------------------------------
+
+int main(int argc, char* const argv[])
+{
+    try {
+        argc_argv args(argc, argv, {
+                {"--locdb", ""},
+                {"-h", false},
+                {"--help", false},
+            });
+        if (args["-h"] || args["--help"] || args.number_of_arguments() != 2) {
+            throw std::runtime_error("Usage: "s + args.program() + sUsage + args.usage_options());
+        }
+        const std::string locdb = args["--locdb"];
+        hidb::setup({}, locdb);
+        get_locdb();
+
+        std::unique_ptr<Chart> chart{import_chart(acmacs::file::read(args[0]))};
+        HiDb imported;
+        imported.importFrom(args[1]);
+        HiDb added;
+        added.add(*chart);
+        const auto next = imported.next_version();
+        VersionedHiDb versioned{std::make_shared<HiDb>()};
+        versioned.add(*chart);
+
+        for (const auto& [db, what]: std::vector<std::pair<const HiDb*, std::string>>{{&imported, "imported"}, {&added, "added"}, {next.get(), "next_version"}, {versioned.snapshot().get(), "versioned"}}) {
+            test_lookups(*db, what);
+            test_query_context(*db, what);
+            test_date_range(*db, what);
+            test_prefix(*db, what);
+            test_bitmaps(*db, what);
+            test_stat(*db, what);
+            test_titer_stat(*db, what);
+        }
+
+        const auto vaccine_index = imported.vaccine_index();
+        for (const auto& antigen: chart->antigens()) {
+            if (!antigen.distinct()) {
+                const auto lookup = imported.lookup_antigen_of_chart(antigen);
+                CHECK(lookup && lookup.found->data().full_name() == antigen.full_name(), antigen.full_name());
+                const auto* vaccine_entry = vaccine_index->find(antigen);
+                CHECK(vaccine_entry && vaccine_entry->antigen_data == lookup.found, antigen.full_name());
+                CHECK(imported.vaccine_index()->find(antigen) == vaccine_entry, antigen.full_name()); // remembered
+            }
+        }
+        test_diff(imported, added);
+
+          // another table with the same antigens and sera, half of them in other passages (serum ids), is added to
+          // a non-empty hidb: antigens and sera are inserted between the existing ones and the existing ones are updated
+        std::unique_ptr<Chart> second{import_chart(acmacs::file::read(args[0]))};
+        second->chart_info().date_ref() = "29990101";
+        for (size_t no = 0; no < second->antigens().size(); no += 2)
+            second->antigens()[no].passage() += "-T";
+        for (size_t no = 0; no < second->sera().size(); no += 2)
+            second->sera()[no].serum_id() += "-T";
+        const auto first_snapshot = versioned.snapshot();
+        versioned.add(*second);
+        const auto second_snapshot = versioned.snapshot();
+        CHECK(second_snapshot->charts().size() == 2 && second_snapshot->antigens().size() > imported.antigens().size(), "second chart");
+        CHECK(first_snapshot->charts().size() == 1 && first_snapshot->antigens().size() == imported.antigens().size(), "snapshot taken before adding second chart");
+        for (const auto& [db, what]: std::vector<std::pair<const HiDb*, std::string>>{{first_snapshot.get(), "first snapshot"}, {second_snapshot.get(), "second chart"}}) {
+            test_lookups(*db, what);
+            test_date_range(*db, what);
+            test_prefix(*db, what);
+            test_bitmaps(*db, what);
+            test_stat(*db, what);
+        }
+
+          // stat records updated after add() are the same as made for both tables at once
+        HiDb both;
+        both.add({chart.get(), second.get()});
+        CHECK(!both.stat_records_made(), "stat is made on request");
+        const std::vector<std::string> dimensions{"virus_type", "lineage", "lab", "year_month", "continent", "country", "assay"};
+        CHECK(both.stat_antigens_by(dimensions, "", "") == second_snapshot->stat_antigens_by(dimensions, "", ""), "stat update");
+        CHECK(both.stat_sera_by(dimensions, false, "", "") == second_snapshot->stat_sera_by(dimensions, false, "", ""), "stat update");
+        CHECK(both.stat_sera_by(dimensions, true, "", "") == second_snapshot->stat_sera_by(dimensions, true, "", ""), "stat update");
+        test_same_records(both.antigen_stat_records(), second_snapshot->antigen_stat_records(), "antigen stat update");
+        test_same_records(both.serum_stat_records(), second_snapshot->serum_stat_records(), "serum stat update");
+
+        test_many_labs(args[0]);
+    }
+    catch (std::exception& err) {
+        std::cerr << "ERROR: " << err.what() << '\n';
+        ++sFailed;
+    }
+    if (sFailed)
+        std::cerr << sFailed << " checks FAILED\n";
+    return static_cast<int>(std::min(sFailed, size_t{125}));
+}
+
+// ----------------------------------------------------------------------
+
+void test_lookups(const HiDb& aHiDb, std::string aWhat)
+{
+    CHECK(!aHiDb.antigens().empty() && !aHiDb.sera().empty(), aWhat);
+    for (const auto& antigen: aHiDb.antigens()) {
+        const auto name = name_for_exact_matching(antigen.data());
+        CHECK(aHiDb.may_contain_antigen(name), aWhat + ": " + name);
+        CHECK(aHiDb.may_contain_antigen_name(antigen.data().name()), aWhat + ": " + name);
+        const auto lookup = aHiDb.lookup_antigen_exactly(name);
+        CHECK(lookup.found == &antigen, aWhat + ": " + name);
+        const auto by_name = aHiDb.find_antigens_by_name(antigen.data().name());
+        CHECK(std::all_of(by_name.begin(), by_name.end(), [&aHiDb](const auto* ag) { return belongs(aHiDb.antigens(), ag); }), aWhat + ": " + name);
+        CHECK(std::find(by_name.begin(), by_name.end(), &antigen) != by_name.end(), aWhat + ": " + name);
+        for (const auto& per_table: antigen.per_table()) {
+            for (const auto& lab_id: per_table.lab_id()) {
+                CHECK(antigen.has_lab_id(lab_id.str()), aWhat + ": " + name + " " + lab_id.str());
+                if (lab_id.str().substr(0, 4) == "CDC#") {
+                    const auto by_cdcid = aHiDb.find_antigens_by_cdcid(lab_id.str().substr(4));
+                    CHECK(std::find(by_cdcid.begin(), by_cdcid.end(), &antigen) != by_cdcid.end(), aWhat + ": " + name + " " + lab_id.str());
+                }
+            }
+        }
+        if (const auto ag_name = antigen.data().name(); ag_name.size() > 3 && ag_name[2] == ' ') { // cdc name, e.g. "MD 1/2017"
+            const auto suggestions = aHiDb.find_antigens_by_name(ag_name.substr(0, 3) + "NOT-IN-HIDB");
+            CHECK(std::find(suggestions.begin(), suggestions.end(), &antigen) != suggestions.end(), aWhat + ": " + name);
+            CHECK(std::all_of(suggestions.begin(), suggestions.end(), [&ag_name](const auto* ag) { return ag->data().name().compare(0, 3, ag_name, 0, 3) == 0; }), aWhat + ": " + name);
+        }
+    }
+    for (const auto& serum: aHiDb.sera()) {
+        const auto name = name_for_exact_matching(serum.data());
+        CHECK(aHiDb.may_contain_serum(name), aWhat + ": " + name);
+        CHECK(aHiDb.lookup_serum_exactly(name) == &serum, aWhat + ": " + name);
+        for (const auto& [table_id, homologous_variant_id]: serum.homologous()) {
+            const auto antigen = aHiDb.lookup_antigen_exactly(string::join({serum.data().name(), homologous_variant_id}));
+            if (antigen) {
+                const auto homologous_sera = aHiDb.find_homologous_sera(*antigen.found);
+                CHECK(std::find(homologous_sera.begin(), homologous_sera.end(), &serum) != homologous_sera.end(), aWhat + ": " + name + " in " + table_id);
+            }
+        }
+    }
+
+    for (const auto& antigen: aHiDb.antigens()) {
+        std::vector<const SerumData*> expected;
+        for (const auto& serum: aHiDb.sera()) {
+            const auto variant_ids = serum.homologous_variant_ids();
+            if (serum.data().name() == antigen.data().name() && std::find(variant_ids.begin(), variant_ids.end(), variant_id(antigen.data())) != variant_ids.end())
+                expected.push_back(&serum);
+        }
+        CHECK(aHiDb.find_homologous_sera(antigen) == expected, aWhat + ": " + name_for_exact_matching(antigen.data()));
+    }
+
+    const std::string missing = "A(H3N2)/NOWHERE/1/1900";
+    const auto lookup = aHiDb.lookup_antigen_exactly(missing);
+    CHECK(!lookup, aWhat);
+    CHECK(aHiDb.may_contain_antigen(missing) || lookup.suggestions.empty(), aWhat + ": suggestions of name rejected by bloom filter");
+    CHECK(aHiDb.lookup_serum_exactly(missing) == nullptr, aWhat);
+    bool thrown = false;
+    try {
+        aHiDb.find_antigen_exactly(missing);
+    }
+    catch (HiDb::NotFound&) {
+        thrown = true;
+    }
+    CHECK(thrown, aWhat);
+}
+
+// ----------------------------------------------------------------------
+
+void test_query_context(const HiDb& aHiDb, std::string aWhat)
+{
+    QueryContext context;
+    for (const auto& antigen: aHiDb.antigens()) {
+        const auto name = name_for_exact_matching(antigen.data());
+        CHECK(aHiDb.find_antigens(name, context) == aHiDb.find_antigens(name), aWhat + ": " + name);
+        CHECK(aHiDb.find_antigens_fuzzy(name, context) == aHiDb.find_antigens_fuzzy(name), aWhat + ": " + name);
+        CHECK(aHiDb.lookup_antigen_exactly(name, context) == &antigen, aWhat + ": " + name);
+    }
+    CHECK(aHiDb.lookup_antigen_exactly("A(H3N2)/NOWHERE/1/1900", context) == nullptr, aWhat);
+    CHECK(aHiDb.may_contain_antigen("A(H3N2)/NOWHERE/1/1900") || context.antigens().empty(), aWhat + ": suggestions of previous query left in context");
+}
+
+// ----------------------------------------------------------------------
+
+void test_date_range(const HiDb& aHiDb, std::string aWhat)
+{
+    for (const auto& [first, last]: std::vector<std::pair<std::string, std::string>>{{"", ""}, {"2010", "2011"}, {"2010-10-01", "2011-01-01"}, {"", "2010-06"}, {"2011", ""}}) {
+        const auto range = aWhat + ": [" + first + ", " + last + ")";
+        const auto antigens = aHiDb.antigens_by_date_range(first, last);
+        const auto expected = static_cast<size_t>(std::count_if(aHiDb.antigens().begin(), aHiDb.antigens().end(), [&first=first, &last=last](const auto& ag) {
+            const auto date = ag.date();
+            return !date.empty() && (first.empty() || date >= first) && (last.empty() || date < last);
+        }));
+        CHECK(antigens.size() == expected, range);
+        CHECK(std::all_of(antigens.begin(), antigens.end(), [&aHiDb](const auto* ag) { return belongs(aHiDb.antigens(), ag); }), range);
+        CHECK(std::is_sorted(antigens.begin(), antigens.end(), [](const auto* a, const auto* b) { return a->date() < b->date(); }), range);
+    }
+
+      // index updated by add() orders antigens of the same date as the one made at once
+    std::vector<const AntigenData*> expected;
+    for (const auto& antigen: aHiDb.antigens()) {
+        if (!antigen.date().empty())
+            expected.push_back(&antigen);
+    }
+    std::stable_sort(expected.begin(), expected.end(), [](const auto* a, const auto* b) { return a->date() < b->date(); });
+    const auto all = aHiDb.antigens_by_date_range("", "");
+    CHECK(std::equal(all.begin(), all.end(), expected.begin(), expected.end()), aWhat + ": order of date index");
+}
+
+// ----------------------------------------------------------------------
+
+void test_prefix(const HiDb& aHiDb, std::string aWhat)
+{
+    const auto& first = aHiDb.antigens().front().data();
+    for (const auto& prefix: {""s, "A("s, first.name().substr(0, 12), first.full_name(), "ZZZ"s}) {
+        std::vector<std::string> expected;
+        for (const auto& antigen: aHiDb.antigens()) {
+            if (const auto full_name = antigen.data().full_name(); full_name.compare(0, prefix.size(), prefix) == 0)
+                expected.push_back(full_name);
+        }
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        CHECK(aHiDb.complete_antigen_full_name(prefix) == expected, aWhat + ": " + prefix);
+        CHECK(aHiDb.complete_antigen_full_name(prefix, 2).size() == std::min(expected.size(), size_t{2}), aWhat + ": " + prefix);
+        const auto antigens = aHiDb.find_antigens_by_full_name_prefix(prefix);
+        CHECK(std::all_of(antigens.begin(), antigens.end(), [&](const auto* ag) { return belongs(aHiDb.antigens(), ag) && ag->data().full_name().compare(0, prefix.size(), prefix) == 0; }), aWhat + ": " + prefix);
+    }
+}
+
+// ----------------------------------------------------------------------
+
+void test_bitmaps(const HiDb& aHiDb, std::string aWhat)
+{
+    CHECK(aHiDb.antigen_bitmaps().size() == aHiDb.antigens().size(), aWhat);
+    CHECK(aHiDb.serum_bitmaps().size() == aHiDb.sera().size(), aWhat);
+    for (const auto& lab: aHiDb.labs()) {
+        std::vector<const AntigenData*> expected_antigens;
+        for (const auto& antigen: aHiDb.antigens()) {
+            if (antigen.has_lab(aHiDb, lab))
+                expected_antigens.push_back(&antigen);
+        }
+        CHECK(aHiDb.list_antigens(lab, "", "") == expected_antigens, aWhat + ": " + lab);
+        std::vector<const SerumData*> expected_sera;
+        for (const auto& serum: aHiDb.sera()) {
+            if (serum.has_lab(aHiDb, lab))
+                expected_sera.push_back(&serum);
+        }
+        CHECK(aHiDb.list_sera(lab, "") == expected_sera, aWhat + ": " + lab);
+    }
+    CHECK(aHiDb.list_antigens("", "", "").size() == aHiDb.antigens().size(), aWhat);
+    CHECK(aHiDb.list_antigens("NO-SUCH-LAB", "", "").empty(), aWhat);
+
+      // bitmaps updated by add() are the same as made from scratch
+    auto ordinals = [](const Bitmap& aBitmap) { std::vector<size_t> result; aBitmap.for_each([&result](size_t aNo) { result.push_back(aNo); }); return result; };
+    auto same = [&ordinals,&aWhat](const BitmapIndex& aIndex, const BitmapIndex& aMade) {
+        for (size_t dimension = 0; dimension < BitmapIndex::DimensionSize; ++dimension) {
+            const auto dim = static_cast<BitmapIndex::Dimension>(dimension);
+            CHECK(aIndex.values(dim) == aMade.values(dim), aWhat + ": dimension " + std::to_string(dimension));
+            for (const auto& value: aMade.values(dim))
+                CHECK(ordinals(aIndex.get(dim, value)) == ordinals(aMade.get(dim, value)), aWhat + ": " + value);
+        }
+    };
+    BitmapIndex antigen_bitmaps, serum_bitmaps;
+    antigen_bitmaps.make(aHiDb, aHiDb.antigens());
+    serum_bitmaps.make(aHiDb, aHiDb.sera());
+    same(aHiDb.antigen_bitmaps(), antigen_bitmaps);
+    same(aHiDb.serum_bitmaps(), serum_bitmaps);
+}
+
+// ----------------------------------------------------------------------
+
+void test_stat(const HiDb& aHiDb, std::string aWhat)
+{
+    aHiDb.prepare_stat();
+    CHECK(aHiDb.stat_antigens_by({"lab", "year_month"}, "", "") == aHiDb.stat_antigens_cube({"lab", "year_month"}, {}, "", ""), aWhat);
+    CHECK(aHiDb.stat_antigens_by({"virus_type"}, "2010", "2011-01") == aHiDb.stat_antigens_cube({"virus_type"}, {}, "2010", "2011-01"), aWhat);
+
+    size_t names = 0;
+    for (const auto& [key, count]: aHiDb.stat_antigens_by({"lab"}, "", ""))
+        names += count;
+    const auto& antigens = aHiDb.antigens();
+    const auto expected_names = static_cast<size_t>(antigens.size() - static_cast<size_t>(std::count_if(antigens.begin() + 1, antigens.end(), [&antigens](const auto& ag) { return ag.data().name() == (&ag - 1)->data().name(); })));
+    CHECK(names == expected_names, aWhat);
+
+    size_t sera = 0;
+    for (const auto& [key, count]: aHiDb.stat_sera_by({"lab"}, true, "", ""))
+        sera += count;
+    CHECK(sera == aHiDb.sera().size(), aWhat);
+
+      // counts are taken from cubes, they agree with records
+    const std::vector<StatRecords::Dimension> dimensions{StatRecords::Lab, StatRecords::YearMonth, StatRecords::Continent};
+    const auto& antigen_records = aHiDb.antigen_stat_records();
+    CHECK(aHiDb.stat_antigens_by({"lab", "year_month", "continent"}, "", "") == GroupBy(antigen_records, dimensions, antigen_records.all()).counts(), aWhat);
+    const auto& serum_records = aHiDb.serum_stat_records();
+    CHECK(aHiDb.stat_sera_by({"lab", "year_month", "continent"}, false, "", "") == GroupBy(serum_records, dimensions, serum_records.all()).counts(), aWhat);
+    CHECK(aHiDb.stat_sera_by({"lab", "year_month", "continent"}, true, "", "") == GroupBy(serum_records, dimensions, serum_records.all(), true).counts(), aWhat);
+}
+
+// ----------------------------------------------------------------------
+
+  // records made at once and updated by add() + prepare_stat() differ in order only
+void test_same_records(const StatRecords& aMade, const StatRecords& aUpdated, std::string aWhat)
+{
+    CHECK(aMade.size() == aUpdated.size(), aWhat);
+    for (size_t record_no = 0; record_no < aMade.size(); ++record_no) {
+        const auto& key = aMade.key(record_no);
+        const auto updated_no = aUpdated.find(key);
+        CHECK(updated_no != StatRecords::NotFound, aWhat + ": " + key);
+        if (updated_no != StatRecords::NotFound) {
+            CHECK(aUpdated.values(updated_no) == aMade.values(record_no), aWhat + ": " + key);
+            CHECK(aUpdated.weight(updated_no) == aMade.weight(record_no), aWhat + ": " + key);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+
+void test_titer_stat(const HiDb& aHiDb, std::string aWhat)
+{
+    const auto statistics = aHiDb.titer_statistics({});
+    size_t titers = 0, less_than = 0;
+    for (const auto& table: aHiDb.charts()) {
+        for (size_t ag_no = 0; ag_no < table.titers().number_of_antigens(); ++ag_no) {
+            for (size_t sr_no = 0; sr_no < table.titers().number_of_sera(); ++sr_no) {
+                if (!std::isnan(table.titers().logged(table.titers().code(ag_no, sr_no)))) { // dont care and unparseable titers are skipped
+                    ++titers;
+                    if (table.titer(ag_no, sr_no)[0] == '<')
+                        ++less_than;
+                }
+            }
+        }
+    }
+    CHECK(statistics.tables().size() == aHiDb.charts().size(), aWhat);
+    CHECK(statistics.total().titers == titers, aWhat);
+    CHECK(statistics.total().less_than == less_than, aWhat);
+
+    const auto table_id = aHiDb.charts().front().table_id();
+    const auto twice = aHiDb.titer_statistics({table_id, table_id});
+    CHECK(twice.tables().size() == 1 && twice.total().titers == aHiDb.titer_statistics({table_id}).total().titers, aWhat + ": table listed twice");
+    std::string message;
+    try {
+        aHiDb.titer_statistics({table_id, "no-such-table"});
+    }
+    catch (HiDb::NotFound& err) {
+        message = err.what();
+    }
+    CHECK(message.find("no-such-table") != std::string::npos, aWhat + ": unknown table_id not reported");
+}
+
+// ----------------------------------------------------------------------
+
+  // the same table from more labs than fit into LabMask
+void test_many_labs(std::string aChartFilename)
+{
+    const auto chart_data = acmacs::file::read(aChartFilename);
+    std::vector<std::unique_ptr<Chart>> charts;
+    for (size_t lab_no = 0; lab_no < LabMaskBits + 8; ++lab_no) {
+        auto& chart = charts.emplace_back(import_chart(chart_data));
+        chart->chart_info().lab_ref() = "LAB" + std::to_string(lab_no);
+    }
+    std::vector<const Chart*> to_add(charts.size());
+    std::transform(charts.begin(), charts.end(), to_add.begin(), [](const auto& chart) { return chart.get(); });
+    HiDb hidb;
+    hidb.add(to_add);
+    CHECK(hidb.labs().size() == charts.size(), "many labs");
+    for (const auto& antigen: hidb.antigens()) {
+        std::vector<std::string> labs;
+        antigen.labs(hidb, labs);
+        CHECK(labs.size() == charts.size(), "many labs: " + antigen.data().full_name());
+        CHECK(antigen.has_lab(hidb, "LAB" + std::to_string(charts.size() - 1)) && !antigen.has_lab(hidb, "NO-SUCH-LAB"), "many labs: " + antigen.data().full_name());
+    }
+    test_bitmaps(hidb, "many labs");
+}
+
+// ----------------------------------------------------------------------
+
+void test_diff(const HiDb& aImported, const HiDb& aAdded)
+{
+    CHECK(aImported.diff(aImported).empty(), "imported vs itself");
+    CHECK(aImported.diff(aAdded).empty(), "imported vs added from the same chart");
+
+    const HiDb empty;
+    const auto diff = empty.diff(aImported);
+    CHECK(diff.tables.added.size() == aImported.charts().size() && diff.tables.removed.empty() && diff.tables.changed.empty(), "empty vs imported");
+    CHECK(diff.antigens.added.size() == aImported.antigens().size() && diff.antigens.removed.empty(), "empty vs imported");
+    CHECK(diff.sera.added.size() == aImported.sera().size() && diff.sera.removed.empty(), "empty vs imported");
+    CHECK(std::is_sorted(diff.antigens.added.begin(), diff.antigens.added.end()), "empty vs imported");
+    const auto reverse = aImported.diff(empty);
+    CHECK(reverse.antigens.removed == diff.antigens.added && reverse.antigens.added.empty(), "imported vs empty");
+}
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
@@ -0,0 +1,112 @@
+#include "titer-stat.hh"
+#include "hidb.hh"
+
+// ----------------------------------------------------------------------
+
+  // Titers of the table converted to three flat arrays, so that loops below
+  // are plain arithmetic over contiguous memory without branches: logged
+  // titer (0 for dont care), weight (1 for titer, 0 for dont care) and less
+  // than flag.
+struct LoggedTiters
+{
+    LoggedTiters(const hidb::TiterMatrix& aTiters);
+
+    std::vector<double> logged;
+    std::vector<double> weight;
+    std::vector<double> less_than;
+};
+
+LoggedTiters::LoggedTiters(const hidb::TiterMatrix& aTiters)
+{
+    using namespace hidb;
+    const size_t size = aTiters.number_of_antigens() * aTiters.number_of_sera();
+    logged.resize(size);
+    weight.resize(size);
+    less_than.resize(size);
+    const TiterMatrix::Code* codes = aTiters.row(0);
+    for (size_t no = 0; no < size; ++no) {
+        const auto code = codes[no];
+        const double value = aTiters.logged(code);
+        if (std::isnan(value))
+            continue;
+        weight[no] = 1.0;
+        switch (aTiters.text_qualifier(code)) { // special titers, e.g. "<20480", are qualified too
+          case TiterMatrix::LessThan:
+              logged[no] = value - 1.0;
+              less_than[no] = 1.0;
+              break;
+          case TiterMatrix::MoreThan:
+              logged[no] = value + 1.0;
+              break;
+          case TiterMatrix::Exact:
+          case TiterMatrix::Special:
+              logged[no] = value;
+              break;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+
+void hidb::TiterStatistics::add(const ChartData& aTable, const std::vector<size_t>& aHomologous)
+{
+    const size_t number_of_antigens = aTable.titers().number_of_antigens(), number_of_sera = aTable.titers().number_of_sera();
+    const LoggedTiters titers(aTable.titers());
+
+      // logged homologous titer and its weight per column, weight is 0 if there is no homologous antigen or its titer is dont care
+    std::vector<double> homologous_logged(number_of_sera), homologous_weight(number_of_sera);
+    for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no) {
+        if (const auto ag_no = aHomologous[sr_no]; ag_no < number_of_antigens) {
+            homologous_logged[sr_no] = titers.logged[ag_no * number_of_sera + sr_no];
+            homologous_weight[sr_no] = titers.weight[ag_no * number_of_sera + sr_no];
+        }
+    }
+
+    std::vector<double> col_logged(number_of_sera), col_weight(number_of_sera), col_less_than(number_of_sera), col_fold_drop(number_of_sera), col_fold_weight(number_of_sera);
+    auto& table_stat = mTables.emplace_back(TableTiterStat{&aTable, std::vector<TiterStat>(number_of_antigens), {}});
+    for (size_t ag_no = 0; ag_no < number_of_antigens; ++ag_no) {
+        const double* logged = titers.logged.data() + ag_no * number_of_sera;
+        const double* weight = titers.weight.data() + ag_no * number_of_sera;
+        const double* less_than = titers.less_than.data() + ag_no * number_of_sera;
+        double row_logged = 0.0, row_weight = 0.0, row_less_than = 0.0, row_fold_drop = 0.0, row_fold_weight = 0.0;
+        for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no) {
+            const double fold_weight = weight[sr_no] * homologous_weight[sr_no];
+            const double fold_drop = (homologous_logged[sr_no] - logged[sr_no]) * fold_weight;
+            row_logged += logged[sr_no];
+            row_weight += weight[sr_no];
+            row_less_than += less_than[sr_no];
+            row_fold_drop += fold_drop;
+            row_fold_weight += fold_weight;
+            col_logged[sr_no] += logged[sr_no];
+            col_weight[sr_no] += weight[sr_no];
+            col_less_than[sr_no] += less_than[sr_no];
+            col_fold_drop[sr_no] += fold_drop;
+            col_fold_weight[sr_no] += fold_weight;
+        }
+        table_stat.antigens[ag_no] = TiterStat{static_cast<size_t>(row_weight), static_cast<size_t>(row_less_than), row_logged, static_cast<size_t>(row_fold_weight), row_fold_drop};
+    }
+    table_stat.sera.reserve(number_of_sera);
+    for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no)
+        table_stat.sera.push_back(TiterStat{static_cast<size_t>(col_weight[sr_no]), static_cast<size_t>(col_less_than[sr_no]), col_logged[sr_no], static_cast<size_t>(col_fold_weight[sr_no]), col_fold_drop[sr_no]});
+
+      // homologous titer against itself was counted above with zero fold drop
+    for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no) {
+        if (homologous_weight[sr_no] > 0.0) {
+            --table_stat.antigens[aHomologous[sr_no]].fold_drops;
+            --table_stat.sera[sr_no].fold_drops;
+        }
+    }
+
+    for (size_t ag_no = 0; ag_no < number_of_antigens; ++ag_no) {
+        mAntigens[aTable.antigens()[ag_no]] += table_stat.antigens[ag_no];
+        mTotal += table_stat.antigens[ag_no];
+    }
+    for (size_t sr_no = 0; sr_no < number_of_sera; ++sr_no)
+        mSera[aTable.sera()[sr_no]] += table_stat.sera[sr_no];
+
+} // hidb::TiterStatistics::add
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
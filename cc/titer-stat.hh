@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+    class ChartData;
+
+// ----------------------------------------------------------------------
+
+      // Summary of titers of a row (antigen) or column (serum).
+      // Titers are logged: log2(titer/10), "<N" is counted as log2(N/10) - 1, ">N" as log2(N/10) + 1, dont care titers are skipped.
+      // Fold drop is log2 of homologous titer divided by titer in the same column (homologous titer itself is not counted).
+    struct TiterStat
+    {
+        size_t titers = 0;
+        size_t less_than = 0;
+        double sum_logged = 0.0;
+        size_t fold_drops = 0;
+        double sum_fold_drop = 0.0;
+
+        inline double mean_logged() const { return titers ? sum_logged / static_cast<double>(titers) : std::nan(""); }
+        inline double gmt() const { return titers ? 10.0 * std::exp2(mean_logged()) : std::nan(""); }
+        inline double mean_fold_drop() const { return fold_drops ? sum_fold_drop / static_cast<double>(fold_drops) : std::nan(""); }
+
+        inline TiterStat& operator += (const TiterStat& aNother)
+            {
+                titers += aNother.titers;
+                less_than += aNother.less_than;
+                sum_logged += aNother.sum_logged;
+                fold_drops += aNother.fold_drops;
+                sum_fold_drop += aNother.sum_fold_drop;
+                return *this;
+            }
+    };
+
+    struct TableTiterStat
+    {
+        const ChartData* table;
+        std::vector<TiterStat> antigens; // per row
+        std::vector<TiterStat> sera;     // per column
+    };
+
+// ----------------------------------------------------------------------
+
+    class TiterStatistics
+    {
+     public:
+        using AgSrRef = std::pair<std::string, std::string>; // name, variant_id
+
+          // aHomologous: row of the homologous antigen for each serum column, values >= number_of_antigens mean no homologous antigen
+        void add(const ChartData& aTable, const std::vector<size_t>& aHomologous);
+
+        inline const std::vector<TableTiterStat>& tables() const { return mTables; }
+          // pooled across tables
+        inline const std::map<AgSrRef, TiterStat>& antigens() const { return mAntigens; }
+        inline const std::map<AgSrRef, TiterStat>& sera() const { return mSera; }
+        inline const TiterStat& total() const { return mTotal; }
+
+     private:
+        std::vector<TableTiterStat> mTables;
+        std::map<AgSrRef, TiterStat> mAntigens;
+        std::map<AgSrRef, TiterStat> mSera;
+        TiterStat mTotal;
+
+    }; // class TiterStatistics
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
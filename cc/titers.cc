@@ -0,0 +1,138 @@
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+
+#include "titers.hh"
+
+// ----------------------------------------------------------------------
+
+hidb::TiterMatrix::TiterMatrix(const std::vector<std::vector<std::string>>& aTiters)
+{
+    mCodes.reserve(aTiters.size() * (aTiters.empty() ? 0 : aTiters.front().size()));
+    for (const auto& row: aTiters) {
+        for (const auto& titer: row)
+            append(titer);
+        end_row();
+    }
+
+} // hidb::TiterMatrix::TiterMatrix
+
+// ----------------------------------------------------------------------
+
+void hidb::TiterMatrix::append(std::string_view aTiter)
+{
+    mCodes.push_back(encode(aTiter));
+
+} // hidb::TiterMatrix::append
+
+// ----------------------------------------------------------------------
+
+void hidb::TiterMatrix::end_row()
+{
+    const size_t row_size = mCodes.size() - mNumberOfAntigens * mNumberOfSera;
+    if (mNumberOfAntigens == 0)
+        mNumberOfSera = row_size;
+    else if (row_size != mNumberOfSera)
+        throw std::runtime_error("TiterMatrix: row " + std::to_string(mNumberOfAntigens) + " has " + std::to_string(row_size) + " titers, expected " + std::to_string(mNumberOfSera));
+    ++mNumberOfAntigens;
+
+} // hidb::TiterMatrix::end_row
+
+// ----------------------------------------------------------------------
+
+hidb::TiterMatrix::Code hidb::TiterMatrix::encode(std::string_view aTiter)
+{
+    if (aTiter == "*")
+        return DontCare;
+
+    Code qualifier = Exact;
+    std::string_view digits = aTiter;
+    if (!digits.empty() && (digits[0] == '<' || digits[0] == '>')) {
+        qualifier = digits[0] == '<' ? LessThan : MoreThan;
+        digits.remove_prefix(1);
+    }
+    if (!digits.empty() && digits.size() <= 5 && (digits[0] != '0' || digits.size() == 1) && std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        const auto value = std::stoul(std::string(digits));
+        if (value <= ValueMask)
+            return static_cast<Code>((qualifier << ValueBits) | value);
+    }
+
+      // cannot be encoded, keep text
+    auto special = std::find(mSpecial.begin(), mSpecial.end(), aTiter);
+    if (special == mSpecial.end()) {
+        if (mSpecial.size() >= ValueMask) // ValueMask is reserved for DontCare
+            throw std::runtime_error("TiterMatrix: too many special titers");
+        special = mSpecial.emplace(mSpecial.end(), aTiter);
+    }
+    return static_cast<Code>((Special << ValueBits) | (special - mSpecial.begin()));
+
+} // hidb::TiterMatrix::encode
+
+// ----------------------------------------------------------------------
+
+std::string hidb::TiterMatrix::titer(size_t aAntigenNo, size_t aSerumNo) const
+{
+    const auto titer_code = code(aAntigenNo, aSerumNo);
+    switch (qualifier(titer_code)) {
+      case Exact:
+          return std::to_string(titer_code & ValueMask);
+      case LessThan:
+          return "<" + std::to_string(titer_code & ValueMask);
+      case MoreThan:
+          return ">" + std::to_string(titer_code & ValueMask);
+      case Special:
+          return dont_care(titer_code) ? std::string("*") : mSpecial[titer_code & ValueMask];
+    }
+    return {};
+
+} // hidb::TiterMatrix::titer
+
+// ----------------------------------------------------------------------
+
+std::vector<std::vector<std::string>> hidb::TiterMatrix::list() const
+{
+    std::vector<std::vector<std::string>> result(mNumberOfAntigens);
+    for (size_t ag_no = 0; ag_no < mNumberOfAntigens; ++ag_no) {
+        result[ag_no].reserve(mNumberOfSera);
+        for (size_t sr_no = 0; sr_no < mNumberOfSera; ++sr_no)
+            result[ag_no].push_back(titer(ag_no, sr_no));
+    }
+    return result;
+
+} // hidb::TiterMatrix::list
+
+// ----------------------------------------------------------------------
+
+double hidb::TiterMatrix::special_value(Code aCode) const
+{
+    if (dont_care(aCode))
+        return 0.0;
+    const auto& text = mSpecial[aCode & ValueMask];
+    const char* start = text.c_str();
+    if (*start == '<' || *start == '>')
+        ++start;
+    return std::strtod(start, nullptr);
+
+} // hidb::TiterMatrix::special_value
+
+// ----------------------------------------------------------------------
+
+hidb::TiterMatrix::Qualifier hidb::TiterMatrix::text_qualifier(Code aCode) const
+{
+    if (qualifier(aCode) != Special || dont_care(aCode))
+        return qualifier(aCode);
+    switch (mSpecial[aCode & ValueMask].front()) {
+      case '<':
+          return LessThan;
+      case '>':
+          return MoreThan;
+      default:
+          return Special;
+    }
+
+} // hidb::TiterMatrix::text_qualifier
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
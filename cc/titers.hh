@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+// ----------------------------------------------------------------------
+
+namespace hidb
+{
+      // Titers of a table stored as 16-bit codes, row per antigen.
+      // Code: 2 bits of qualifier, 14 bits of value. Titers that cannot be
+      // reproduced from value and qualifier (e.g. too big or with leading
+      // zeros) are kept as text in the per table special list, code value is
+      // an index in that list. "*" (dont care) is a special code.
+    class TiterMatrix
+    {
+     public:
+        using Code = uint16_t;
+        enum Qualifier : Code { Exact = 0, LessThan = 1, MoreThan = 2, Special = 3 };
+        static constexpr const Code ValueBits = 14;
+        static constexpr const Code ValueMask = (Code{1} << ValueBits) - 1;
+        static constexpr const Code DontCare = (Special << ValueBits) | ValueMask;
+
+        inline TiterMatrix() = default;
+        TiterMatrix(const std::vector<std::vector<std::string>>& aTiters);
+
+        inline size_t number_of_antigens() const { return mNumberOfAntigens; }
+        inline size_t number_of_sera() const { return mNumberOfSera; }
+        inline bool empty() const { return mNumberOfAntigens == 0; }
+
+        inline Code code(size_t aAntigenNo, size_t aSerumNo) const { return mCodes[aAntigenNo * mNumberOfSera + aSerumNo]; }
+        inline const Code* row(size_t aAntigenNo) const { return mCodes.data() + aAntigenNo * mNumberOfSera; }
+        std::string titer(size_t aAntigenNo, size_t aSerumNo) const; // original text
+        std::vector<std::vector<std::string>> list() const;
+
+        static inline Qualifier qualifier(Code aCode) { return static_cast<Qualifier>(aCode >> ValueBits); }
+          // qualifier of the titer text: the same as qualifier() for encoded titers, special titers
+          // (e.g. "<20480") are qualified by their prefix, Special for dont care and special titers without prefix
+        Qualifier text_qualifier(Code aCode) const;
+        static inline bool dont_care(Code aCode) { return aCode == DontCare; }
+          // numeric value of the titer ignoring qualifier, 0 for dont care and unparseable special titers
+        inline double value(Code aCode) const { return qualifier(aCode) == Special ? special_value(aCode) : static_cast<double>(aCode & ValueMask); }
+          // log2(value/10), NaN for dont care
+        inline double logged(Code aCode) const { const auto val = value(aCode); return val > 0.0 ? std::log2(val / 10.0) : std::nan(""); }
+
+          // building row by row (used by import)
+        void append(std::string_view aTiter);
+        void end_row();
+
+     private:
+        size_t mNumberOfAntigens = 0, mNumberOfSera = 0;
+        std::vector<Code> mCodes;
+        std::vector<std::string> mSpecial;
+
+        Code encode(std::string_view aTiter);
+        double special_value(Code aCode) const;
+
+    }; // class TiterMatrix
+
+} // namespace hidb
+
+// ----------------------------------------------------------------------
+/// Local Variables:
+/// eval: (if (fboundp 'eu-rename-buffer) (eu-rename-buffer))
+/// End:
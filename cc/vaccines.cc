@@ -1,7 +1,12 @@
 #include <algorithm>
 #include <functional>
 #include <iomanip>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <future>
 
+#include "locationdb/locdb.hh"
 #include "hidb.hh"
 #include "variant-id.hh"
 #include "vaccines.hh"
@@ -170,22 +175,102 @@ std::string hidb::Vaccines::report(PassageType aPassageType, size_t aIndent, siz
 
 // ----------------------------------------------------------------------
 
+hidb::VaccineIndex::VaccineIndex(const HiDb& aHiDb)
+    : mHiDb(aHiDb)
+{
+    if (!mHiDb.charts().empty()) {
+        const auto virus_type = mHiDb.charts().front().chart_info().virus_type();
+        std::string not_found_location; // avoid reporting to std::cerr
+        for (const auto& [subtype_lineage, names]: sVaccines) {
+            if (subtype_lineage.substr(0, virus_type.size()) == virus_type) { // B matches BVICTORIA and BYAMAGATA
+                for (const auto& name_type: names) {
+                    for (const auto* antigen_data: mHiDb.find_antigens_by_name(virus_type + "/" + name_type.name, &not_found_location))
+                        mEntries.emplace(antigen_data, make_entry(*antigen_data));
+                }
+            }
+        }
+    }
+
+} // hidb::VaccineIndex::VaccineIndex
+
+// ----------------------------------------------------------------------
+
+hidb::VaccineIndex::Entry hidb::VaccineIndex::make_entry(const hidb::AntigenSerumData<Antigen>& aAntigenData) const
+{
+    Entry entry{&aAntigenData, mHiDb.charts()[aAntigenData.most_recent_table().table_id()].chart_info().date(), {}};
+    for (const auto* sd: mHiDb.find_homologous_sera(aAntigenData))
+        entry.homologous_sera.push_back({sd, hidb::name_for_exact_matching(sd->data()), mHiDb.charts()[sd->most_recent_table().table_id()].chart_info().date()});
+    return entry;
+
+} // hidb::VaccineIndex::make_entry
+
+// ----------------------------------------------------------------------
+
+const hidb::VaccineIndex::Entry* hidb::VaccineIndex::find(const Antigen& aAntigen) const
+{
+    const std::string full_name = aAntigen.full_name();
+    {
+        std::shared_lock<std::shared_mutex> lock{mMutex};
+        if (const auto found = mOfChartAntigen.find(full_name); found != mOfChartAntigen.end())
+            return found->second;
+    }
+
+      // first request for this chart antigen: hidb lookup and making entry are done without holding the lock,
+      // if another thread meanwhile inserted the same, its entry is kept and the one made here is dropped
+    const auto lookup = mHiDb.lookup_antigen_of_chart(aAntigen);
+    std::optional<Entry> made;
+    if (lookup) {
+        std::shared_lock<std::shared_mutex> lock{mMutex};
+        const bool present = mEntries.find(lookup.found) != mEntries.end(); // name in chart may differ from hidb one (e.g. passage)
+        lock.unlock();
+        if (!present)
+            made = make_entry(*lookup.found);
+    }
+
+    std::unique_lock<std::shared_mutex> lock{mMutex};
+    const Entry* entry = nullptr;
+    if (lookup)
+        entry = made ? &mEntries.try_emplace(lookup.found, std::move(*made)).first->second : &mEntries.at(lookup.found);
+    return mOfChartAntigen.try_emplace(full_name, entry).first->second;
+
+} // hidb::VaccineIndex::find
+
+// ----------------------------------------------------------------------
+
+std::shared_ptr<const hidb::VaccineIndex> hidb::HiDb::vaccine_index() const
+{
+    auto index = std::atomic_load(&mVaccineIndex);
+    if (!index) {
+        auto made = std::make_shared<const VaccineIndex>(*this);
+        if (std::atomic_compare_exchange_strong(&mVaccineIndex, &index, made)) // another thread may have made it meanwhile, then index is set to that one
+            index = made;
+    }
+    return index;
+
+} // hidb::HiDb::vaccine_index
+
+// ----------------------------------------------------------------------
+
 void hidb::vaccines_for_name(Vaccines& aVaccines, std::string aName, const Chart& aChart, bool aVerbose)
 {
-    const auto& hidb = hidb::get(aChart.chart_info().virus_type(), aVerbose ? report_time::Yes : report_time::No);
+    vaccines_for_name(aVaccines, aName, aChart, *hidb::get(aChart.chart_info().virus_type(), aVerbose ? report_time::Yes : report_time::No).vaccine_index());
+
+} // hidb::vaccines_for_name
+
+// ----------------------------------------------------------------------
+
+void hidb::vaccines_for_name(Vaccines& aVaccines, std::string aName, const Chart& aChart, const VaccineIndex& vaccine_index)
+{
     for (size_t ag_no: aChart.antigens().find_by_name(aName)) {
-        try {
-            const auto& ag = static_cast<const Antigen&>(aChart.antigen(ag_no));
-              // std::cerr << ag.full_name() << std::endl;
-            const auto& data = hidb.find_antigen_of_chart(ag);
+        const auto& ag = static_cast<const Antigen&>(aChart.antigen(ag_no));
+          // std::cerr << ag.full_name() << std::endl;
+        if (const auto* entry = vaccine_index.find(ag); entry) {
             std::vector<hidb::Vaccines::HomologousSerum> homologous_sera;
-            for (const auto* sd: hidb.find_homologous_sera(data)) {
-                if (const auto sr_no = aChart.sera().find_by_full_name(hidb::name_for_exact_matching(sd->data())))
-                    homologous_sera.emplace_back(*sr_no, static_cast<const Serum*>(&aChart.serum(*sr_no)), sd, hidb.charts()[sd->most_recent_table().table_id()].chart_info().date());
+            for (const auto& hs: entry->homologous_sera) {
+                if (const auto sr_no = aChart.sera().find_by_full_name(hs.name_for_exact_matching))
+                    homologous_sera.emplace_back(*sr_no, static_cast<const Serum*>(&aChart.serum(*sr_no)), hs.serum_data, hs.most_recent_table_date);
             }
-            aVaccines.add(ag_no, ag, &data, std::move(homologous_sera), hidb.charts()[data.most_recent_table().table_id()].chart_info().date());
-        }
-        catch (hidb::HiDb::NotFound&) {
+            aVaccines.add(ag_no, ag, entry->antigen_data, std::move(homologous_sera), entry->most_recent_table_date);
         }
     }
     aVaccines.sort();
@@ -214,6 +299,34 @@ hidb::VaccinesOfChart hidb::vaccines(const Chart& aChart, bool aVerbose)
 
 } // hidb::vaccines
 
+// ----------------------------------------------------------------------
+
+std::vector<hidb::VaccinesOfChart> hidb::vaccines(const std::vector<const Chart*>& aCharts, bool aVerbose)
+{
+      // hidb::get() and loading locdb are not thread safe, hidbs and their vaccine indices are prepared here before starting threads
+    get_locdb();
+    std::vector<std::shared_ptr<const VaccineIndex>> vaccine_indices(aCharts.size());
+    std::transform(aCharts.begin(), aCharts.end(), vaccine_indices.begin(), [aVerbose](const Chart* chart) { return hidb::get(chart->chart_info().virus_type(), aVerbose ? report_time::Yes : report_time::No).vaccine_index(); });
+
+    std::vector<VaccinesOfChart> result(aCharts.size());
+    std::atomic<size_t> next_chart{0};
+    auto worker = [&]() {
+        for (size_t chart_no = next_chart++; chart_no < aCharts.size(); chart_no = next_chart++) {
+            for (const auto& name_type: vaccine_names(*aCharts[chart_no]))
+                vaccines_for_name(result[chart_no].emplace_back(name_type), name_type.name, *aCharts[chart_no], *vaccine_indices[chart_no]);
+        }
+    };
+    const size_t number_of_threads = std::max(size_t{1}, std::min(static_cast<size_t>(std::thread::hardware_concurrency()), aCharts.size()));
+    std::vector<std::future<void>> threads;
+    for (size_t thread_no = 1; thread_no < number_of_threads; ++thread_no)
+        threads.push_back(std::async(std::launch::async, worker));
+    worker();
+    for (auto& thread: threads)
+        thread.get();
+    return result;
+
+} // hidb::vaccines
+
 // ----------------------------------------------------------------------
 // ----------------------------------------------------------------------
 
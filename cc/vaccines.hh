@@ -2,6 +2,11 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <unordered_map>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
 #include <algorithm>
 
 #include "acmacs-chart-1/chart.hh"
@@ -127,7 +132,7 @@ namespace hidb
         Vaccine mNameType;
         std::vector<Entry> mEntries[PassageTypeSize];
 
-        friend void vaccines_for_name(Vaccines& aVaccines, std::string aName, const Chart& aChart, bool aVerbose);
+        friend void vaccines_for_name(Vaccines& aVaccines, std::string aName, const Chart& aChart, const VaccineIndex& aVaccineIndex);
 
         static inline PassageType passage_type(const Antigen& aAntigen)
             {
@@ -162,6 +167,46 @@ namespace hidb
 
     }; // class Vaccines
 
+// ----------------------------------------------------------------------
+
+      // Vaccine antigens of a HiDb with their homologous sera and dates of the
+      // most recent tables, see HiDb::vaccine_index(). Entries are keyed by
+      // hidb antigen, all hidb variants of the vaccine names are found on
+      // construction. Antigen of a chart is looked up by
+      // HiDb::lookup_antigen_of_chart() on the first request, hidb antigen
+      // found (or not found) for its full name is remembered.
+    class VaccineIndex
+    {
+     public:
+        struct HomologousSerum
+        {
+            const hidb::AntigenSerumData<Serum>* serum_data;
+            std::string name_for_exact_matching;
+            std::string most_recent_table_date;
+        };
+
+        struct Entry
+        {
+            const hidb::AntigenSerumData<Antigen>* antigen_data;
+            std::string most_recent_table_date;
+            std::vector<HomologousSerum> homologous_sera;
+        };
+
+        VaccineIndex(const HiDb& aHiDb);
+
+          // returns nullptr if antigen is not in hidb, thread safe
+        const Entry* find(const Antigen& aAntigen) const;
+
+     private:
+        const HiDb& mHiDb;
+        mutable std::shared_mutex mMutex; // exclusive just for inserting, lookups and making entries are done without it
+        mutable std::map<const hidb::AntigenSerumData<Antigen>*, Entry> mEntries; // hidb antigen -> entry
+        mutable std::unordered_map<std::string, const Entry*> mOfChartAntigen;   // full name of chart antigen -> entry, nullptr if not in hidb
+
+        Entry make_entry(const hidb::AntigenSerumData<Antigen>& aAntigenData) const;
+
+    }; // class VaccineIndex
+
 // ----------------------------------------------------------------------
 
     class VaccinesOfChart : public std::vector<Vaccines>
@@ -180,7 +225,10 @@ namespace hidb
     const std::vector<Vaccine>& vaccine_names(const Chart& aChart);
     Vaccines* find_vaccines_in_chart(std::string aName, const Chart& aChart);
     void vaccines_for_name(Vaccines& aVaccines, std::string aName, const Chart& aChart, bool aVerbose = false);
+    void vaccines_for_name(Vaccines& aVaccines, std::string aName, const Chart& aChart, const VaccineIndex& aVaccineIndex);
     VaccinesOfChart vaccines(const Chart& aChart, bool aVerbose = false);
+      // charts are processed concurrently, result has VaccinesOfChart for each chart in the same order
+    std::vector<VaccinesOfChart> vaccines(const std::vector<const Chart*>& aCharts, bool aVerbose = false);
 
 } // namespace hidb
 